@@ -0,0 +1,182 @@
+/**
+ * @file runtimeBench.cpp
+ * @brief Scalability benchmark of the event runtime.
+ *
+ * Registers N empty events with mixed periods directly in a `Runtime`, runs them for a
+ * fixed time and reports, for each N:
+ * - wakeups per second (activations of all the events) and wake ups of the timer thread,
+ * - lateness percentiles of the activations, from a sample of events,
+ * - resident memory per event,
+ * - threads of the process,
+ * - CPU time of the whole process per activation.
+ *
+ * The runtime environment variables (`T_WORKERS`, `T_DISPATCH`, `T_SPIN`...) apply as in
+ * a compiled program. Usage: `runtimeBench [--duration <s>] [--slack <ms>] [<event count>...]`.
+ *
+ * @author Adrián Zamora Sánchez
+ * @see Runtime.h
+ */
+
+#include "Runtime.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <malloc.h>
+#include <string>
+#include <sys/resource.h>
+#include <thread>
+#include <vector>
+
+/// Periods assigned in turn to the events, from 10 ms to 1 s.
+static const std::chrono::milliseconds PERIODS[] = {std::chrono::milliseconds(10),  std::chrono::milliseconds(20),
+                                                    std::chrono::milliseconds(50),  std::chrono::milliseconds(100),
+                                                    std::chrono::milliseconds(200), std::chrono::milliseconds(500),
+                                                    std::chrono::milliseconds(1000)};
+
+/// Events with timing histograms, at most this many are sampled so the histograms do not dominate the memory.
+static constexpr std::size_t MAX_SAMPLED = 1024;
+
+/// Activations of every event, a single counter is enough next to the cost of a activation.
+static std::atomic<std::uint64_t> activations{0};
+
+/// Body of the benchmark events, only counts the activation.
+static void countActivation(void **) {
+    activations.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Reads a field of `/proc/self/status`.
+ * @param field Field name, with its colon.
+ * @return First number of the field, 0 if it is missing.
+ */
+static long readStatus(const std::string &field) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+
+    while (std::getline(status, line)) {
+        if (line.compare(0, field.size(), field) == 0)
+            return std::strtol(line.c_str() + field.size(), nullptr, 10);
+    }
+
+    return 0;
+}
+
+/// CPU time consumed by all the threads of the process.
+static std::chrono::microseconds processCpuTime() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return std::chrono::seconds(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+           std::chrono::microseconds(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+}
+
+/**
+ * @brief Runs N events for a fixed time and prints a result line.
+ * @param count Number of events.
+ * @param duration Measured time.
+ * @param slack Slack of every event.
+ */
+static void runBenchmark(std::size_t count, std::chrono::milliseconds duration, std::chrono::microseconds slack) {
+    // The memory of the previous run is returned to the system so it is not counted as free space
+    malloc_trim(0);
+    long rssBefore = readStatus("VmRSS:");
+
+    std::vector<std::string> ids(count);
+    std::vector<EventHandle> handles(count);
+    std::size_t sampleStep = std::max<std::size_t>(1, count / MAX_SAMPLED);
+    std::size_t sampled = 0;
+
+    {
+        Runtime runtime;
+
+        for (std::size_t i = 0; i < count; ++i) {
+            ids[i] = "bench" + std::to_string(i);
+            std::chrono::microseconds period = PERIODS[i % (sizeof(PERIODS) / sizeof(PERIODS[0]))];
+            handles[i] = runtime.registerEvent(ids[i].c_str(), period, countActivation, 0, nullptr, 0);
+            runtime.setSlack(handles[i], slack);
+
+            Event *ev = runtime.getEvent(handles[i]);
+            if (ev && i % sampleStep == 0) {
+                ev->enableStats();
+                ++sampled;
+            }
+        }
+
+        // Every event is scheduled at once, their first activations are due together
+        std::uint64_t activationsBefore = activations.load();
+        std::uint64_t timerBefore = runtime.getTimerStats().wakeups;
+        std::chrono::microseconds cpuBefore = processCpuTime();
+        for (EventHandle handle : handles) {
+            runtime.scheduleEvent(handle, nullptr);
+        }
+
+        std::this_thread::sleep_for(duration);
+
+        std::uint64_t done = activations.load() - activationsBefore;
+        std::uint64_t timerWakeups = runtime.getTimerStats().wakeups - timerBefore;
+        std::chrono::microseconds cpu = processCpuTime() - cpuBefore;
+        long rssAfter = readStatus("VmRSS:");
+        long threads = readStatus("Threads:");
+
+        // Lateness of the sampled events, read while their workers may still record
+        Histogram lateness;
+        std::chrono::nanoseconds maxLateness{0};
+        for (std::size_t i = 0; i < count; ++i) {
+            const Event *ev = runtime.getEvent(handles[i]);
+            if (!ev)
+                continue;
+            maxLateness = std::max(maxLateness, ev->getMaxLateness());
+            if (const EventStats *stats = ev->getStats())
+                lateness.merge(stats->lateness);
+        }
+
+        for (EventHandle handle : handles) {
+            runtime.terminateEvent(handle);
+        }
+
+        auto us = [](std::chrono::nanoseconds value) { return value.count() / 1000.0; };
+        double seconds = std::chrono::duration<double>(duration).count();
+        double rssPerEvent = (static_cast<double>(rssAfter - rssBefore) * 1024.0 -
+                              static_cast<double>(sampled * sizeof(EventStats))) /
+                             static_cast<double>(count);
+
+        fmt::print("{:>8} {:>12.0f} {:>10.0f} {:>9.1f} {:>9.1f} {:>9.1f} {:>9.1f} {:>10.1f} {:>10.0f} {:>8} {:>9.2f}\n",
+                   count, done / seconds, timerWakeups / seconds, us(lateness.getPercentile(50)), us(lateness.getPercentile(90)),
+                   us(lateness.getPercentile(99)), us(lateness.getPercentile(99.9)), us(maxLateness), rssPerEvent,
+                   threads, done ? static_cast<double>(cpu.count()) / static_cast<double>(done) : 0.0);
+        std::fflush(stdout);
+    }
+}
+
+int main(int argc, char **argv) {
+    std::chrono::milliseconds duration(2000);
+    std::chrono::microseconds slack(0);
+    std::vector<std::size_t> counts;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--duration" && i + 1 < argc) {
+            duration = std::chrono::milliseconds(static_cast<long>(std::atof(argv[++i]) * 1000.0));
+        } else if (arg == "--slack" && i + 1 < argc) {
+            slack = std::chrono::microseconds(static_cast<long>(std::atof(argv[++i]) * 1000.0));
+        } else {
+            counts.push_back(static_cast<std::size_t>(std::strtoul(arg.c_str(), nullptr, 10)));
+        }
+    }
+
+    if (counts.empty())
+        counts = {10, 100, 1000, 10000, 100000};
+
+    fmt::print("{:>8} {:>12} {:>10} {:>9} {:>9} {:>9} {:>9} {:>10} {:>10} {:>8} {:>9}\n", "events", "wakeups/s",
+               "timer/s", "p50 us", "p90 us", "p99 us", "p99.9 us", "max us", "rss/ev B", "threads", "cpu/act us");
+
+    for (std::size_t count : counts) {
+        if (count > 0)
+            runBenchmark(count, duration, slack);
+    }
+
+    return 0;
+}
@@ -172,4 +172,13 @@ void *ExitNode::accept(SemanticVisitor &visitor) {
 
 llvm::Value *ExitNode::accept(IRGenerator &visitor) {
     return visitor.visit(*this);
-};
\ No newline at end of file
+};
+
+/* SuspendNode */
+void *SuspendNode::accept(SemanticVisitor &visitor) {
+    return visitor.visit(*this);
+};
+
+llvm::Value *SuspendNode::accept(IRGenerator &visitor) {
+    return visitor.visit(*this);
+};
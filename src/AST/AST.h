@@ -10,6 +10,7 @@
 #include "TimeStamp.h"
 #include "Type.h"
 #include "spdlog/spdlog.h"
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <memory>
@@ -1234,9 +1235,18 @@ class EventNode : public ASTNode {
     std::string id;
     TimeCommand command;
     int limit;
+    OverrunPolicy overrun = OverrunPolicy::OVERRUN_SKIP;
+    int priority = 0;
+    int queueCapacity = 0;
+    QueueFullPolicy queueFull = QueueFullPolicy::QUEUE_BLOCK;
     std::vector<std::unique_ptr<ASTNode>> paramList;
     std::unique_ptr<ASTNode> timeStmt;
+    std::unique_ptr<ASTNode> slack;
+    bool aligned = false;
+    std::unique_ptr<ASTNode> condition;
+    std::vector<std::string> triggers;
     std::unique_ptr<CodeBlockNode> codeBlock;
+    bool coroutine = false;
 
   public:
     /**
@@ -1246,6 +1256,13 @@ class EventNode : public ASTNode {
      * @param timeCommand activation mechanism of this event node.
      * @param activationTime TimeLiteral / VariableRef with the time of the event.
      * @param codeBlock code executed in this event block.
+     * @param execLimit number of executions before the event stops, 0 for no limit.
+     * @param overrunPolicy behaviour when the body runs longer than the period.
+     * @param eventPriority dispatch priority, higher values run first when the workers are busy.
+     * @param capacity size of the argument queue, 0 if each call replaces the pending arguments.
+     * @param fullPolicy behaviour when a call finds the argument queue full.
+     * @param slackTime TimeLiteral with the delay allowed after each activation time, nullptr for none.
+     * @param phaseAligned keeps the activations aligned with the schedule call when the runtime staggers the phases.
      */
     explicit EventNode(std::string identifier,
                        std::vector<std::unique_ptr<ASTNode>> &params,
@@ -1253,9 +1270,29 @@ class EventNode : public ASTNode {
                        std::unique_ptr<ASTNode> time,
                        std::unique_ptr<CodeBlockNode> block,
                        const SourceLocation &loc = SourceLocation{},
-                       int execLimit = 0)
+                       int execLimit = 0,
+                       OverrunPolicy overrunPolicy = OverrunPolicy::OVERRUN_SKIP,
+                       int eventPriority = 0,
+                       int capacity = 0,
+                       QueueFullPolicy fullPolicy = QueueFullPolicy::QUEUE_BLOCK,
+                       std::unique_ptr<ASTNode> slackTime = nullptr,
+                       bool phaseAligned = false)
         : ASTNode(loc), id(identifier), paramList(std::move(params)), command(timeCommand), timeStmt(std::move(time)),
-          codeBlock(std::move(block)), limit(execLimit){};
+          slack(std::move(slackTime)), aligned(phaseAligned), codeBlock(std::move(block)), limit(execLimit), overrun(overrunPolicy),
+          priority(eventPriority), queueCapacity(capacity), queueFull(fullPolicy){};
+
+    /**
+     * @brief Constructor for the condition-triggered (`when`) event node.
+     * @param id identifier of the event.
+     * @param condition expression that activates the event when it becomes true.
+     * @param codeBlock code executed in this event block.
+     */
+    explicit EventNode(std::string identifier,
+                       std::unique_ptr<ASTNode> cond,
+                       std::unique_ptr<CodeBlockNode> block,
+                       const SourceLocation &loc = SourceLocation{})
+        : ASTNode(loc), id(identifier), command(TimeCommand::TIME_WHEN), limit(0), condition(std::move(cond)),
+          codeBlock(std::move(block)){};
 
     /**
      * @brief Getter for the code block.
@@ -1275,12 +1312,78 @@ class EventNode : public ASTNode {
      */
     int getLimit() { return limit; }
 
+    /**
+     * @brief Getter for the overrun policy.
+     * @return Behaviour when the body runs longer than the period.
+     */
+    OverrunPolicy getOverrunPolicy() { return overrun; }
+
+    /**
+     * @brief Getter for the priority.
+     * @return Dispatch priority of the event.
+     */
+    int getPriority() { return priority; }
+
+    /**
+     * @brief Getter for the slack.
+     * @return Delay allowed after each activation time to group the timer wake ups, nullptr if there is none.
+     */
+    ASTNode *getSlack() { return slack.get(); }
+
+    /**
+     * @brief Phase alignment check.
+     * @return `true` if the activations keep the phase of the schedule call instead of being staggered.
+     */
+    bool isAligned() const { return aligned; }
+
+    /**
+     * @brief Getter for the queue capacity.
+     * @return Size of the argument queue, 0 if the event is not queued.
+     */
+    int getQueueCapacity() { return queueCapacity; }
+
+    /**
+     * @brief Getter for the full-queue policy.
+     * @return Behaviour when a call finds the argument queue full.
+     */
+    QueueFullPolicy getQueueFullPolicy() { return queueFull; }
+
     /**
      * @brief Getter for the time command.
      * @return TimeCommand keyword.
      */
     TimeCommand getTimeCommand() { return command; }
 
+    /**
+     * @brief Getter for the activation condition.
+     * @return Condition of a `when` event, nullptr for timed events.
+     */
+    ASTNode *getCondition() { return condition.get(); }
+
+    /**
+     * @brief Adds a variable read by the activation condition.
+     * @param name Identifier of the variable.
+     */
+    void addTrigger(const std::string &name) {
+        if (std::find(triggers.begin(), triggers.end(), name) == triggers.end())
+            triggers.push_back(name);
+    }
+
+    /**
+     * @brief Getter for the trigger variables.
+     * @return Variables whose stores re-evaluate the activation condition.
+     */
+    const std::vector<std::string> &getTriggers() const { return triggers; }
+
+    /// Marks the body as a coroutine, it contains a `wait` or `yield` statement.
+    void setCoroutine() { coroutine = true; }
+
+    /**
+     * @brief Coroutine check.
+     * @return `true` if the body can suspend its activation.
+     */
+    bool isCoroutine() const { return coroutine; }
+
     /**
      * @brief Returns the ammount of parameters in this event.
      * @return Amount of parameters in this event definition.
@@ -1310,8 +1413,19 @@ class EventNode : public ASTNode {
     bool equals(const ASTNode *other) const override {
         if (auto o = dynamic_cast<const EventNode *>(other)) {
             // Returns the result of comparing all the attributes
-            return id == o->id && timeStmt->equals(o->timeStmt.get()) && codeBlock->equals(o->codeBlock.get()) &&
-                   command == o->command && paramList == o->paramList;
+            // Timed events compare the time statement, `when` events the condition
+            const ASTNode *activation = timeStmt ? timeStmt.get() : condition.get();
+            const ASTNode *otherActivation = o->timeStmt ? o->timeStmt.get() : o->condition.get();
+            if (!activation || !otherActivation)
+                return false;
+
+            // Events without slack only match other events without it
+            bool sameSlack = slack ? o->slack && slack->equals(o->slack.get()) : !o->slack;
+
+            return id == o->id && activation->equals(otherActivation) && codeBlock->equals(o->codeBlock.get()) &&
+                   command == o->command && overrun == o->overrun && priority == o->priority && sameSlack &&
+                   aligned == o->aligned &&
+                   queueCapacity == o->queueCapacity && queueFull == o->queueFull && paramList == o->paramList;
         }
 
         return false;
@@ -1363,4 +1477,59 @@ class ExitNode : public ASTNode {
 
     /// @copydoc ASTNode::accept(IRGenerator &visitor)
     llvm::Value *accept(IRGenerator &visitor) override;
-};
\ No newline at end of file
+};
+
+/**
+ * @class SuspendNode
+ * @brief Represents a suspension point in the body of a event (`wait` and `yield` statements).
+ *
+ * The activation is suspended and its worker thread runs other events, it continues
+ * at the same point after the wait time (`wait`) or as soon as a worker is free (`yield`).
+ *
+ * @see ASTNode
+ * @see EventNode
+ */
+class SuspendNode : public ASTNode {
+    std::unique_ptr<ASTNode> timeStmt;
+
+  public:
+    /**
+     * @brief Constructor for the suspend node.
+     * @param time TimeLiteral / VariableRef with the wait time, nullptr for a `yield`.
+     */
+    explicit SuspendNode(std::unique_ptr<ASTNode> time, const SourceLocation &loc = SourceLocation{})
+        : ASTNode(loc), timeStmt(std::move(time)){};
+
+    /**
+     * @brief Getter for the time statement.
+     * @return Node with the wait time, nullptr for a `yield`.
+     */
+    ASTNode *getTimeStmt() { return timeStmt.get(); }
+
+    /// @copydoc ASTNode::getValue
+    std::string getValue() const override { return timeStmt ? "wait" : "yield"; }
+
+    /// @copydoc ASTNode::print
+    std::string print() const override {
+        return "\n[" + getValue() + ",returnNode" + (timeStmt ? timeStmt->print() : "") + "]";
+    }
+
+    /// @copydoc ASTNode::equals
+    bool equals(const ASTNode *other) const override {
+        if (auto o = dynamic_cast<const SuspendNode *>(other)) {
+            // Returns the result of comparing all the attributes
+            if (!timeStmt || !o->timeStmt)
+                return !timeStmt && !o->timeStmt;
+
+            return timeStmt->equals(o->timeStmt.get());
+        }
+
+        return false;
+    }
+
+    /// @copydoc ASTNode::accept(SemanticVisitor &)
+    void *accept(SemanticVisitor &visitor) override;
+
+    /// @copydoc ASTNode::accept(IRGenerator &visitor)
+    llvm::Value *accept(IRGenerator &visitor) override;
+};
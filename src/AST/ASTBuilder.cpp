@@ -62,6 +62,8 @@ std::unique_ptr<ASTNode> ASTBuilder::visit(TParser::StmtContext *ctx) {
         return visit(ctx->loop());
     } else if (ctx->eventDef()) {
         return visit(ctx->eventDef());
+    } else if (ctx->suspendStmt()) {
+        return visit(ctx->suspendStmt());
     }
 
     throw std::runtime_error("Not a valid stmt");
@@ -118,40 +120,40 @@ std::unique_ptr<ASTNode> ASTBuilder::visit(TParser::OperandExprContext *ctx) {
 
     // The operand is a pointer to a identifier
     if (operand->TYPE_PTR()) {
-        return std::make_unique<VariableRefNode>(operand->IDENTIFIER()->getText(), loc, true);
+        return std::make_unique<VariableRefNode>(operand->identifier()->getText(), loc, true);
     }
 
     // The operand is a unary prefix operation
     if (operand->INC() && operand->INC()->getSymbol()->getTokenIndex() == operand->start->getTokenIndex()) {
-        return std::make_unique<UnaryOperationNode>(operand->IDENTIFIER()->getText(),
+        return std::make_unique<UnaryOperationNode>(operand->identifier()->getText(),
                                                     true, // prefix is true
                                                     "++", // isInc is true
                                                     loc);
     }
     if (operand->DEC() && operand->DEC()->getSymbol()->getTokenIndex() == operand->start->getTokenIndex()) {
-        return std::make_unique<UnaryOperationNode>(operand->IDENTIFIER()->getText(),
+        return std::make_unique<UnaryOperationNode>(operand->identifier()->getText(),
                                                     true, // prefix is true
                                                     "--", // isInc is false
                                                     loc);
     }
 
     // The operand is a unary postfix operation
-    if (operand->IDENTIFIER()) {
+    if (operand->identifier()) {
         if (operand->INC()) {
-            return std::make_unique<UnaryOperationNode>(operand->IDENTIFIER()->getText(),
+            return std::make_unique<UnaryOperationNode>(operand->identifier()->getText(),
                                                         false, // prefix is false
                                                         "++",  // isInc is true
                                                         loc);
         }
         if (operand->DEC()) {
-            return std::make_unique<UnaryOperationNode>(operand->IDENTIFIER()->getText(),
+            return std::make_unique<UnaryOperationNode>(operand->identifier()->getText(),
                                                         false, // prefix is false
                                                         "--",  // isInc is false
                                                         loc);
         }
 
         // Simple variable
-        return std::make_unique<VariableRefNode>(operand->IDENTIFIER()->getText(), loc, false);
+        return std::make_unique<VariableRefNode>(operand->identifier()->getText(), loc, false);
     }
 
     throw std::runtime_error("Not a valid operand");
@@ -228,6 +230,8 @@ std::unique_ptr<ASTNode> ASTBuilder::visit(TParser::Time_literalContext *ctx) {
 
 TimeStamp ASTBuilder::visit(TParser::TimeStampContext *ctx) {
     // Gets the time stamp or throws a runtime error
+    if (ctx->TIME_US())
+        return TimeStamp::TYPE_US;
     if (ctx->TIME_TICK())
         return TimeStamp::TYPE_TICK;
     if (ctx->TIME_SEC())
@@ -244,7 +248,7 @@ std::unique_ptr<ASTNode> ASTBuilder::visit(TParser::VariableDecContext *ctx) {
     Type type = visit(ctx->type());
     SourceLocation loc(ctx->getStart()->getLine(), ctx->getStart()->getCharPositionInLine());
 
-    return std::make_unique<VariableDecNode>(type, ctx->IDENTIFIER()->getText(), loc);
+    return std::make_unique<VariableDecNode>(type, ctx->identifier()->getText(), loc);
 }
 
 std::unique_ptr<ASTNode> ASTBuilder::visit(TParser::VariableAssignContext *ctx) {
@@ -256,11 +260,11 @@ std::unique_ptr<ASTNode> ASTBuilder::visit(TParser::VariableAssignContext *ctx)
 
     // If this is a variable declaration + assignment visit the type
     if (ctx->variableDec()) {
-        varName = ctx->variableDec()->IDENTIFIER()->getText();
+        varName = ctx->variableDec()->identifier()->getText();
         type = visit(ctx->variableDec()->type());
         typeString = ctx->variableDec()->type()->getText();
     } else {
-        varName = ctx->IDENTIFIER()->getText();
+        varName = ctx->identifier()->getText();
         type = Type(SupportedTypes::TYPE_VOID);
     }
 
@@ -271,15 +275,15 @@ std::unique_ptr<ASTNode> ASTBuilder::visit(TParser::VariableAssignContext *ctx)
 }
 
 std::unique_ptr<ASTNode> ASTBuilder::visit(TParser::FunctionDefinitionContext *ctx) {
-    std::string id = ctx->IDENTIFIER()->getText();
+    std::string id = ctx->identifier()->getText();
     Type type = visit(ctx->type());
     SourceLocation loc(ctx->getStart()->getLine(), ctx->getStart()->getCharPositionInLine());
 
     // Visits all the param types
     std::vector<std::unique_ptr<ASTNode>> params;
     if (ctx->params() != nullptr && !ctx->params()->isEmpty()) {
-        for (int i = 0; i < ctx->params()->IDENTIFIER().size(); i++) {
-            std::string id = ctx->params()->IDENTIFIER(i)->getText();
+        for (int i = 0; i < ctx->params()->identifier().size(); i++) {
+            std::string id = ctx->params()->identifier(i)->getText();
             Type type = visit(ctx->params()->paramType(i));
             SourceLocation paramLoc(ctx->params()->getStart()->getLine(),
                                     ctx->params()->getStart()->getCharPositionInLine());
@@ -298,7 +302,7 @@ std::unique_ptr<ASTNode> ASTBuilder::visit(TParser::FunctionDefinitionContext *c
 }
 
 std::unique_ptr<ASTNode> ASTBuilder::visit(TParser::FunctionDeclarationContext *ctx) {
-    std::string id = ctx->IDENTIFIER()->getText();
+    std::string id = ctx->identifier()->getText();
     Type type = visit(ctx->type());
     SourceLocation loc(ctx->getStart()->getLine(), ctx->getStart()->getCharPositionInLine());
 
@@ -311,7 +315,7 @@ std::unique_ptr<ASTNode> ASTBuilder::visit(TParser::FunctionDeclarationContext *
 }
 
 std::unique_ptr<ASTNode> ASTBuilder::visit(TParser::FunctionCallContext *ctx) {
-    std::string id = ctx->IDENTIFIER()->getText();
+    std::string id = ctx->identifier()->getText();
     std::vector<std::unique_ptr<ASTNode>> params;
     SourceLocation loc(ctx->getStart()->getLine(), ctx->getStart()->getCharPositionInLine());
 
@@ -430,7 +434,7 @@ std::unique_ptr<ASTNode> ASTBuilder::visit(TParser::EventBlockContext *ctx) {
             stmt.push_back(visit(stmtCtx));
         } else if (auto exitStmt = dynamic_cast<TParser::ExitStmtContext *>(child)) {
             SourceLocation loc(exitStmt->getStart()->getLine(), exitStmt->getStart()->getCharPositionInLine());
-            stmt.push_back(std::make_unique<ExitNode>(exitStmt->IDENTIFIER()->getText(), loc));
+            stmt.push_back(std::make_unique<ExitNode>(exitStmt->identifier()->getText(), loc));
         }
     }
 
@@ -438,8 +442,6 @@ std::unique_ptr<ASTNode> ASTBuilder::visit(TParser::EventBlockContext *ctx) {
 }
 
 std::unique_ptr<ASTNode> ASTBuilder::visit(TParser::EventDefContext *ctx) {
-    // Setting the time command
-    TimeCommand command = visit(ctx->timeCommand());
     int execLimit = 0;
 
     // Visit the time block
@@ -451,11 +453,20 @@ std::unique_ptr<ASTNode> ASTBuilder::visit(TParser::EventDefContext *ctx) {
     std::unique_ptr<ASTNode> timeNode;
     SourceLocation loc(ctx->getStart()->getLine(), ctx->getStart()->getCharPositionInLine());
 
+    // Condition-triggered event, activated when the expression becomes true
+    if (ctx->WHEN()) {
+        return std::make_unique<EventNode>(ctx->identifier(0)->getText(), visit(ctx->expr()), std::move(codeBlockPtr),
+                                           loc);
+    }
+
+    // Setting the time command
+    TimeCommand command = visit(ctx->timeCommand());
+
     // Visits all the param types
     std::vector<std::unique_ptr<ASTNode>> params;
     if (ctx->params() != nullptr && !ctx->params()->isEmpty()) {
-        for (int i = 0; i < ctx->params()->IDENTIFIER().size(); i++) {
-            std::string id = ctx->params()->IDENTIFIER(i)->getText();
+        for (int i = 0; i < ctx->params()->identifier().size(); i++) {
+            std::string id = ctx->params()->identifier(i)->getText();
             Type type = visit(ctx->params()->paramType(i));
             SourceLocation loc(ctx->params()->getStart()->getLine(),
                                ctx->params()->getStart()->getCharPositionInLine());
@@ -469,21 +480,84 @@ std::unique_ptr<ASTNode> ASTBuilder::visit(TParser::EventDefContext *ctx) {
         execLimit = visit(ctx->eventLimitCondition());
     }
 
+    // Visits the overrun policy, missed activations are skipped by default
+    OverrunPolicy overrun = OverrunPolicy::OVERRUN_SKIP;
+    if (ctx->eventOverrunPolicy()) {
+        overrun = visit(ctx->eventOverrunPolicy());
+    }
+
+    // Visits the dispatch priority, all the events have the same one by default
+    int priority = 0;
+    if (ctx->eventPriority()) {
+        priority = visit(ctx->eventPriority());
+    }
+
+    // Visits the slack, without it each activation wakes up the timers at its exact time
+    std::unique_ptr<ASTNode> slack;
+    if (ctx->eventSlack()) {
+        slack = visit(ctx->eventSlack()->time_literal());
+    }
+
+    // Visits the argument queue, without it a new call replaces the pending arguments
+    int queueCapacity = 0;
+    QueueFullPolicy queueFull = QueueFullPolicy::QUEUE_BLOCK;
+    if (ctx->eventQueue()) {
+        queueCapacity = stoi(ctx->eventQueue()->NUMBER_LITERAL()->getText());
+        queueFull = visit(ctx->eventQueue());
+    }
+
     // Getting the time from a literal or a variable reference
     if (ctx->time_literal()) {
         timeNode = visit(ctx->time_literal());
-    } else if (ctx->IDENTIFIER(1)) {
-        timeNode = std::make_unique<VariableRefNode>(ctx->IDENTIFIER(1)->getText(), loc);
+    } else if (ctx->identifier(1)) {
+        timeNode = std::make_unique<VariableRefNode>(ctx->identifier(1)->getText(), loc);
     }
 
-    return std::make_unique<EventNode>(ctx->IDENTIFIER(0)->getText(), params, command, std::move(timeNode),
-                                       std::move(codeBlockPtr), loc, execLimit);
+    return std::make_unique<EventNode>(ctx->identifier(0)->getText(), params, command, std::move(timeNode),
+                                       std::move(codeBlockPtr), loc, execLimit, overrun, priority, queueCapacity,
+                                       queueFull, std::move(slack), ctx->ALIGNED() != nullptr);
+}
+
+std::unique_ptr<ASTNode> ASTBuilder::visit(TParser::SuspendStmtContext *ctx) {
+    SourceLocation loc(ctx->getStart()->getLine(), ctx->getStart()->getCharPositionInLine());
+
+    // `yield` has no wait time
+    std::unique_ptr<ASTNode> timeNode;
+    if (ctx->time_literal()) {
+        timeNode = visit(ctx->time_literal());
+    } else if (ctx->identifier()) {
+        timeNode = std::make_unique<VariableRefNode>(ctx->identifier()->getText(), loc);
+    }
+
+    return std::make_unique<SuspendNode>(std::move(timeNode), loc);
 }
 
 int ASTBuilder::visit(TParser::EventLimitConditionContext *ctx) {
     return stoi(ctx->NUMBER_LITERAL()->getText());
 }
 
+OverrunPolicy ASTBuilder::visit(TParser::EventOverrunPolicyContext *ctx) {
+    if (ctx->CATCHUP())
+        return OverrunPolicy::OVERRUN_CATCHUP;
+    if (ctx->COALESCE())
+        return OverrunPolicy::OVERRUN_COALESCE;
+
+    return OverrunPolicy::OVERRUN_SKIP;
+}
+
+int ASTBuilder::visit(TParser::EventPriorityContext *ctx) {
+    return stoi(ctx->NUMBER_LITERAL()->getText());
+}
+
+QueueFullPolicy ASTBuilder::visit(TParser::EventQueueContext *ctx) {
+    if (ctx->DROPOLDEST())
+        return QueueFullPolicy::QUEUE_DROP_OLDEST;
+    if (ctx->DROPNEWEST())
+        return QueueFullPolicy::QUEUE_DROP_NEWEST;
+
+    return QueueFullPolicy::QUEUE_BLOCK;
+}
+
 Type ASTBuilder::visit(TParser::TypeContext *ctx) {
     // Type dispatch from tokens to Supported types
     if (ctx->TYPE_INT())
@@ -207,6 +207,13 @@ class ASTBuilder {
      */
     std::unique_ptr<ASTNode> visit(TParser::EventBlockContext *ctx);
 
+    /**
+     * @brief Visits a `wait` or `yield` statement.
+     * @param ctx Context of the suspend statement.
+     * @return AST node associated with the suspend statement.
+     */
+    std::unique_ptr<ASTNode> visit(TParser::SuspendStmtContext *ctx);
+
     /**
      * @brief Visits a event time command.
      * @param ctx Context of the time command.
@@ -227,4 +234,25 @@ class ASTBuilder {
      * @return Number of limit executions before event stop.
      */
     int visit(TParser::EventLimitConditionContext *ctx);
+
+    /**
+     * @brief Visits a event overrun policy.
+     * @param ctx Context of the event overrun policy.
+     * @return Behaviour when the event body runs longer than its period.
+     */
+    OverrunPolicy visit(TParser::EventOverrunPolicyContext *ctx);
+
+    /**
+     * @brief Visits a event priority.
+     * @param ctx Context of the event priority.
+     * @return Dispatch priority of the event, higher values run first.
+     */
+    int visit(TParser::EventPriorityContext *ctx);
+
+    /**
+     * @brief Visits a event argument queue.
+     * @param ctx Context of the event queue.
+     * @return Behaviour when a call finds the queue full.
+     */
+    QueueFullPolicy visit(TParser::EventQueueContext *ctx);
 };
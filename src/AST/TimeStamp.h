@@ -11,11 +11,17 @@
 #include <iostream>
 #include <string>
 
-/// Time stamps for time type
-enum TimeStamp { TYPE_TICK, TYPE_SEC, TYPE_MIN, TYPE_HR };
+/// Time stamps for time type, a tick is a millisecond
+enum TimeStamp { TYPE_US, TYPE_TICK, TYPE_SEC, TYPE_MIN, TYPE_HR };
 
 /// Time management commands
-enum TimeCommand { TIME_EVERY, TIME_AT, TIME_AFTER };
+enum TimeCommand { TIME_EVERY, TIME_AT, TIME_AFTER, TIME_WHEN };
+
+/// Behaviour of a periodic event when its body runs longer than the period
+enum OverrunPolicy { OVERRUN_SKIP, OVERRUN_CATCHUP, OVERRUN_COALESCE };
+
+/// Behaviour of a queued event when its argument queue is full
+enum QueueFullPolicy { QUEUE_BLOCK, QUEUE_DROP_OLDEST, QUEUE_DROP_NEWEST };
 
 /**
  * @brief Generates the string for the time stamp.
@@ -26,6 +32,8 @@ enum TimeCommand { TIME_EVERY, TIME_AT, TIME_AFTER };
  */
 inline std::string timeToString(TimeStamp type) {
     switch (type) {
+    case TimeStamp::TYPE_US:
+        return "us";
     case TimeStamp::TYPE_TICK:
         return "tick";
     case TimeStamp::TYPE_SEC:
@@ -50,7 +58,47 @@ inline std::string timeCommandToString(TimeCommand command) {
         return "every";
     case TimeCommand::TIME_AT:
         return "at";
+    case TimeCommand::TIME_AFTER:
+        return "after";
+    case TimeCommand::TIME_WHEN:
+        return "when";
     default:
         return "Unknown time command";
     }
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Generates the string for the overrun policy.
+ * @param policy OverrunPolicy object.
+ * @return string representation of the policy.
+ */
+inline std::string overrunPolicyToString(OverrunPolicy policy) {
+    switch (policy) {
+    case OverrunPolicy::OVERRUN_SKIP:
+        return "skip";
+    case OverrunPolicy::OVERRUN_CATCHUP:
+        return "catchup";
+    case OverrunPolicy::OVERRUN_COALESCE:
+        return "coalesce";
+    default:
+        return "Unknown overrun policy";
+    }
+}
+
+/**
+ * @brief Generates the string for the full-queue policy.
+ * @param policy QueueFullPolicy object.
+ * @return string representation of the policy.
+ */
+inline std::string queueFullPolicyToString(QueueFullPolicy policy) {
+    switch (policy) {
+    case QueueFullPolicy::QUEUE_BLOCK:
+        return "block";
+    case QueueFullPolicy::QUEUE_DROP_OLDEST:
+        return "dropoldest";
+    case QueueFullPolicy::QUEUE_DROP_NEWEST:
+        return "dropnewest";
+    default:
+        return "Unknown full-queue policy";
+    }
+}
@@ -24,43 +24,118 @@ struct CodegenContext {
     /// Stack of IR code blocks.
     std::vector<llvm::BasicBlock *> blockStack;
 
+    /// String values, `%TString = { ptr data, i64 length }` as the TString of the runtime.
+    llvm::StructType *stringType;
+
     /// Module and IRBuilder set up.
     explicit CodegenContext() : IRBuilder(IRContext), IRModule(std::make_unique<llvm::Module>("program", IRContext)) {
         llvm::LLVMContext &C = IRContext;
         llvm::Type *i8PtrTy = llvm::PointerType::get(llvm::Type::getInt8Ty(C), 0);
         llvm::Type *i32Ty = llvm::Type::getInt32Ty(C);
+        llvm::Type *i64Ty = llvm::Type::getInt64Ty(C);
         llvm::Type *voidTy = llvm::Type::getVoidTy(C);
         llvm::Type *floatTy = llvm::Type::getFloatTy(C);
+        stringType = llvm::StructType::create(C, {i8PtrTy, i64Ty}, "TString");
 
         llvm::FunctionType *callbackTy = llvm::FunctionType::get(voidTy, false);
         llvm::PointerType *callbackPtrTy = llvm::PointerType::getUnqual(callbackTy);
 
-        // Insert built-in functions
-        IRModule->getOrInsertFunction("intToString", llvm::FunctionType::get(i8PtrTy, {i32Ty}, false));
-        IRModule->getOrInsertFunction("floatToString", llvm::FunctionType::get(i8PtrTy, {floatTy}, false));
-        IRModule->getOrInsertFunction("print", llvm::FunctionType::get(voidTy, {i8PtrTy}, true));
-        IRModule->getOrInsertFunction("strlen", llvm::FunctionType::get(i32Ty, {i8PtrTy}, false));
+        // Insert built-in functions, `strlen` is generated inline from the string length
+        IRModule->getOrInsertFunction("intToString", llvm::FunctionType::get(stringType, {i32Ty}, false));
+        IRModule->getOrInsertFunction("floatToString", llvm::FunctionType::get(stringType, {floatTy}, false));
+        IRModule->getOrInsertFunction("print", llvm::FunctionType::get(voidTy, {i32Ty}, true));
+
+        // String regions, the runtime strings are released when their frame ends
+        IRModule->getOrInsertFunction("enterStringScope", llvm::FunctionType::get(i64Ty, false));
+        IRModule->getOrInsertFunction("leaveStringScope", llvm::FunctionType::get(voidTy, {i64Ty}, false));
+        IRModule->getOrInsertFunction("leaveStringScopeKeeping",
+                                      llvm::FunctionType::get(stringType, {i64Ty, i8PtrTy, i64Ty}, false));
+        IRModule->getOrInsertFunction("leaveStringScopeKeepingVars",
+                                      llvm::FunctionType::get(voidTy, {i64Ty, i32Ty}, true));
+        IRModule->getOrInsertFunction(
+            "storeRefString",
+            llvm::FunctionType::get(voidTy, {llvm::PointerType::getUnqual(stringType), i8PtrTy, i64Ty}, false));
+        IRModule->getOrInsertFunction(
+            "adoptRefString", llvm::FunctionType::get(voidTy, {llvm::PointerType::getUnqual(stringType)}, false));
 
         IRModule->getOrInsertFunction("registerEventData",
-                                      llvm::FunctionType::get(llvm::Type::getVoidTy(C),
+                                      llvm::FunctionType::get(i64Ty, // event handle
                                                               {
                                                                   i8PtrTy,               // id
-                                                                  floatTy,               // time
+                                                                  i64Ty,                 // period in microseconds
                                                                   i8PtrTy,               // fn pointer
                                                                   i32Ty,                 // argCount
                                                                   i32Ty->getPointerTo(), // int* argTypes
-                                                                  i32Ty                  // limit
+                                                                  i32Ty,                 // limit
+                                                                  i32Ty,                 // time command
+                                                                  i32Ty,                 // overrun policy
+                                                                  i32Ty                  // priority
+                                                              },
+                                                              false));
+        IRModule->getOrInsertFunction("registerEventTable",
+                                      llvm::FunctionType::get(voidTy,
+                                                              {
+                                                                  i8PtrTy, // EventDescriptor table
+                                                                  i32Ty    // number of descriptors
                                                               },
                                                               false));
         IRModule->getOrInsertFunction("scheduleEventData",
                                       llvm::FunctionType::get(voidTy,
                                                               {
-                                                                  i8PtrTy,                // const char* id
+                                                                  i64Ty,                  // event handle
+                                                                  i8PtrTy->getPointerTo() // void** argv
+                                                              },
+                                                              false));
+        IRModule->getOrInsertFunction("batchEventData",
+                                      llvm::FunctionType::get(voidTy,
+                                                              {
+                                                                  i64Ty,                  // event handle
                                                                   i8PtrTy->getPointerTo() // void** argv
                                                               },
                                                               false));
+        IRModule->getOrInsertFunction("flushEventBatch", llvm::FunctionType::get(voidTy, false));
+        IRModule->getOrInsertFunction("configureEventQueue",
+                                      llvm::FunctionType::get(voidTy,
+                                                              {
+                                                                  i64Ty, // event handle
+                                                                  i32Ty, // capacity
+                                                                  i32Ty  // full-queue policy
+                                                              },
+                                                              false));
+        IRModule->getOrInsertFunction("configureEventSlack",
+                                      llvm::FunctionType::get(voidTy,
+                                                              {
+                                                                  i64Ty, // event handle
+                                                                  i64Ty  // slack in microseconds
+                                                              },
+                                                              false));
+        IRModule->getOrInsertFunction("alignEventPhase", llvm::FunctionType::get(voidTy, {i64Ty}, false));
+
+        IRModule->getOrInsertFunction("registerWhenEventData",
+                                      llvm::FunctionType::get(i64Ty, // event handle
+                                                              {
+                                                                  i8PtrTy, // id
+                                                                  i8PtrTy  // fn pointer
+                                                              },
+                                                              false));
+        IRModule->getOrInsertFunction("updateEventCondition",
+                                      llvm::FunctionType::get(voidTy,
+                                                              {
+                                                                  i64Ty, // event handle
+                                                                  i32Ty  // condition value
+                                                              },
+                                                              false));
+
+        IRModule->getOrInsertFunction("exitEvent", llvm::FunctionType::get(voidTy, {i64Ty}, false));
+
+        // Low-latency mode requested with `--realtime`
+        IRModule->getOrInsertFunction("enableRealtime", llvm::FunctionType::get(voidTy, false));
 
-        IRModule->getOrInsertFunction("exitEvent", llvm::FunctionType::get(voidTy, {i8PtrTy}, false));
+        // Coroutine event bodies, suspended at their `wait` and `yield` statements
+        IRModule->getOrInsertFunction("suspendEvent", llvm::FunctionType::get(voidTy, {i8PtrTy, i64Ty}, false));
+        IRModule->getOrInsertFunction("beginEventCoroutine", llvm::FunctionType::get(voidTy, false));
+        IRModule->getOrInsertFunction("malloc", llvm::FunctionType::get(i8PtrTy, {i64Ty}, false));
+        IRModule->getOrInsertFunction("free", llvm::FunctionType::get(voidTy, {i8PtrTy}, false));
 
         // Program main function and basic block set up
         llvm::FunctionType *FT = llvm::FunctionType::get(llvm::Type::getInt32Ty(IRContext), false);
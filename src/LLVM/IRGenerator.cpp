@@ -1,4 +1,6 @@
 #include "IRGenerator.h"
+#include <algorithm>
+#include <cmath>
 #include <llvm/IR/Verifier.h>
 #include <string.h>
 
@@ -58,7 +60,7 @@ llvm::Type *IRGenerator::getLlvmType(Type type) {
     case SupportedTypes::TYPE_CHAR:
         return llvm::Type::getInt8Ty(ctx.IRContext);
     case SupportedTypes::TYPE_STRING:
-        return llvm::PointerType::get(llvm::Type::getInt8Ty(ctx.IRContext), 0);
+        return ctx.stringType;
     case SupportedTypes::TYPE_BOOL:
         return llvm::Type::getInt1Ty(ctx.IRContext);
     case SupportedTypes::TYPE_VOID:
@@ -101,8 +103,10 @@ llvm::Value *IRGenerator::visit(LiteralNode &node) {
             v.erase(v.size() - 1, 1);
         }
 
-        // STRING: global string
-        return ctx.IRBuilder.CreateGlobalStringPtr(v);
+        // STRING: global string and its length
+        llvm::Constant *data = ctx.IRBuilder.CreateGlobalStringPtr(v);
+        llvm::Constant *length = llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx.IRContext), v.size());
+        return llvm::ConstantStruct::get(ctx.stringType, {data, length});
     }
     case SupportedTypes::TYPE_BOOL: {
         bool v = std::get<bool>(value);
@@ -127,8 +131,8 @@ llvm::Value *IRGenerator::visit(BinaryExprNode &node) {
     llvm::Value *L, *R;
     if (operationType == SupportedTypes::TYPE_STRING) {
         // Generates a UndefValue as placeholder for future constant folding
-        L = llvm::UndefValue::get(llvm::PointerType::get(llvm::Type::getInt8Ty(ctx.IRContext), 0));
-        R = llvm::UndefValue::get(llvm::PointerType::get(llvm::Type::getInt8Ty(ctx.IRContext), 0));
+        L = llvm::UndefValue::get(ctx.stringType);
+        R = llvm::UndefValue::get(ctx.stringType);
     } else {
         L = node.getLeft()->accept(*this);
         R = node.getRight()->accept(*this);
@@ -258,6 +262,9 @@ llvm::Value *IRGenerator::visit(UnaryOperationNode &node) {
     // Loading the result
     ctx.IRBuilder.CreateStore(result, addr);
 
+    // The `when` events that read this variable check their condition again
+    notifyWhenEvents(symbol);
+
     // If this node is a prefix unary operator the return value is the operation over the variable value
     if (node.isPrefix()) {
         return result;
@@ -270,19 +277,28 @@ llvm::Value *IRGenerator::visit(UnaryOperationNode &node) {
 llvm::Value *IRGenerator::visit(VariableDecNode &node) {
     llvm::Type *varType = getLlvmType(node.getType());
 
-    // Gets the current function
-    llvm::BasicBlock *currentFunction = ctx.blockStack.back();
+    // Allocating memory for the variable, registered with its Symbol in the SymbolTable
+    return createVariable(symtab.getCurrentScope()->getSymbol(node.getValue()), varType);
+}
 
-    // Creates a temporal builder that points to the begin of the current basic block
-    llvm::IRBuilder<> tmpBuilder(currentFunction, currentFunction->begin());
+llvm::Value *IRGenerator::createVariable(Symbol *symbol, llvm::Type *type) {
+    llvm::Value *addr;
 
-    // Allocating memory for the variable
-    llvm::AllocaInst *allocaInst = tmpBuilder.CreateAlloca(varType, nullptr, node.getValue() + "_ptr");
+    // The conditions of the `when` events read their variables from any function, only main declares them
+    if (symbol->isTrigger()) {
+        addr = new llvm::GlobalVariable(*ctx.IRModule, type, false, llvm::GlobalValue::InternalLinkage,
+                                        llvm::Constant::getNullValue(type), symbol->getID() + "_ptr");
+    } else {
+        // Gets the current function
+        llvm::BasicBlock *currentFunction = ctx.blockStack.back();
 
-    // Registers this new allocation associated with the Symbol in the SymbolTable
-    symtab.getCurrentScope()->getSymbol(node.getValue())->setLlvmValue(allocaInst);
+        // Creates a temporal builder that points to the begin of the current basic block
+        llvm::IRBuilder<> tmpBuilder(currentFunction, currentFunction->begin());
+        addr = tmpBuilder.CreateAlloca(type, nullptr, symbol->getID() + "_ptr");
+    }
 
-    return allocaInst;
+    symbol->setLlvmValue(addr);
+    return addr;
 }
 
 llvm::Value *IRGenerator::visit(VariableAssignNode &node) {
@@ -323,27 +339,29 @@ llvm::Value *IRGenerator::visit(VariableAssignNode &node) {
         // Type dispatch from Supported Type to LLVM::Type
         llvm::Type *varType = getLlvmType(node.getType());
 
-        // Gets the current function
-        llvm::BasicBlock *currentFunction = ctx.blockStack.back();
-
-        // Creates a temporal builder that points to the begin of the current basic block
-        llvm::IRBuilder<> tmpBuilder(currentFunction, currentFunction->begin());
-
-        // Allocating memory for the variable
-        llvm::AllocaInst *allocaInst = tmpBuilder.CreateAlloca(varType, nullptr, node.getValue() + "_ptr");
-
-        // Registers this new allocation associated with the Symbol in the SymbolTable
-        symb->setLlvmValue(allocaInst);
+        // Allocating memory for the variable, registered with its Symbol in the SymbolTable
+        llvm::Value *addr = createVariable(symb, varType);
 
         // Getting the memory address where the value is stored
-        ctx.IRBuilder.CreateStore(assignVal, allocaInst);
+        ctx.IRBuilder.CreateStore(assignVal, addr);
 
-        return allocaInst;
+        return addr;
     }
 
     // Gets the memory address and stores the value (ONLY ASSIGNMENT)
     llvm::Value *alloc = symb->getLlvmValue();
-    ctx.IRBuilder.CreateStore(assignVal, alloc);
+    if (symb->isPtr() && symb->getType() == SupportedTypes::TYPE_STRING) {
+        // A string stored through a reference outlives the frame that created it, literals are copied too so the
+        // next store can free the copy
+        std::vector<llvm::Value *> args = {alloc};
+        appendStringArgs(assignVal, args);
+        ctx.IRBuilder.CreateCall(ctx.IRModule->getFunction("storeRefString"), args);
+    } else {
+        ctx.IRBuilder.CreateStore(assignVal, alloc);
+    }
+
+    // The `when` events that read this variable check their condition again
+    notifyWhenEvents(symb);
 
     return alloc;
 }
@@ -362,6 +380,10 @@ llvm::Value *IRGenerator::visit(VariableRefNode &node) {
         errorList.push_back(CompilerError(CompilerPhase::IR_GEN, node.getSourceLocation(), node.getValue(), errorMsg));
     }
 
+    // Loading a variable in static storage
+    if (auto *global = llvm::dyn_cast<llvm::GlobalVariable>(alloc); global && !symbol->isPtr())
+        return ctx.IRBuilder.CreateLoad(global->getValueType(), global, node.getValue() + "_val");
+
     // Returning a direct value
     if (llvm::isa<llvm::Constant>(alloc) || symbol->isPtr()) {
         return alloc;
@@ -397,9 +419,12 @@ llvm::Value *IRGenerator::visit(VariableRefNode &node) {
 llvm::Value *IRGenerator::visit(FunctionDefNode &node) {
     // Previous state save
     bool prevReturned = hasReturned;
+    llvm::Value *prevStringScope = stringScope;
+    CoroutineContext prevCoroutine = coroutine;
     llvm::BasicBlock *savedBB = ctx.IRBuilder.GetInsertBlock();
 
     hasReturned = false;
+    coroutine = CoroutineContext{};
 
     // Getting the param definition (only types)
     std::vector<llvm::Type *> paramTypes;
@@ -423,6 +448,9 @@ llvm::Value *IRGenerator::visit(FunctionDefNode &node) {
     llvm::BasicBlock *entry = llvm::BasicBlock::Create(ctx.IRContext, "entry", function);
     ctx.pushFunction(entry);
 
+    // The strings created by the function are released at its return
+    stringScope = ctx.IRBuilder.CreateCall(ctx.IRModule->getFunction("enterStringScope"), {}, "string_scope");
+
     // Setting all the params as arguments in their symbol in the symbol table
     unsigned idx = 0;
     for (auto &arg : function->args()) {
@@ -440,6 +468,7 @@ llvm::Value *IRGenerator::visit(FunctionDefNode &node) {
     node.getCodeBlock()->accept(*this);
 
     if (!hasReturned) {
+        generateFrameExit(nullptr);
         if (node.getType().type == SupportedTypes::TYPE_VOID) {
             ctx.IRBuilder.CreateRetVoid();
         } else {
@@ -455,6 +484,8 @@ llvm::Value *IRGenerator::visit(FunctionDefNode &node) {
         ctx.IRBuilder.SetInsertPoint(savedBB);
     }
     hasReturned = prevReturned;
+    stringScope = prevStringScope;
+    coroutine = prevCoroutine;
 
     // DEBUG info
     llvm::verifyFunction(*function);
@@ -479,8 +510,16 @@ llvm::Value *IRGenerator::visit(FunctionDecNode &node) {
 };
 
 llvm::Value *IRGenerator::generatePrintCall(FunctionCallNode &node) {
-    // Getting the arguments values
+    // The strings returned by calls in the arguments are only needed by this print
+    llvm::Value *printScope = nullptr;
+    for (int i = 0; i < node.getParamsCount() && !printScope; i++) {
+        if (dynamic_cast<FunctionCallNode *>(node.getParam(i)))
+            printScope = ctx.IRBuilder.CreateCall(ctx.IRModule->getFunction("enterStringScope"), {}, "print_scope");
+    }
+
+    // Getting the arguments values, the number of strings goes first
     std::vector<llvm::Value *> args;
+    args.push_back(llvm::ConstantInt::get(llvm::Type::getInt32Ty(ctx.IRContext), node.getParamsCount()));
     for (int i = 0; i < node.getParamsCount(); i++) {
         llvm::Value *argVal;
 
@@ -493,25 +532,53 @@ llvm::Value *IRGenerator::generatePrintCall(FunctionCallNode &node) {
         // Usage of a reference instead of direct value
         if (auto varRef = dynamic_cast<VariableRefNode *>(node.getParam(i))) {
             if (varRef->isRef()) {
-                args.push_back(symb->getLlvmValue());
+                appendStringArgs(symb->getLlvmValue(), args);
                 continue;
             }
         }
 
-        // Expressions, strings and literal values are generated here
+        // Expressions, strings and literal values are generated here, each string is passed as its data and length
         argVal = node.getParam(i)->accept(*this);
-        args.push_back(argVal);
+        appendStringArgs(argVal, args);
     }
 
-    // Pushing the NULL var_arg terminator
-    args.push_back(llvm::ConstantPointerNull::get(llvm::PointerType::get(llvm::Type::getInt8Ty(ctx.IRContext), 0)));
-
     // Returns the function call IR
     llvm::Function *callee = ctx.IRModule->getFunction(node.getValue());
-    return ctx.IRBuilder.CreateCall(callee, args, callee->getReturnType()->isVoidTy() ? "" : "calltmp");
+    llvm::Value *call = ctx.IRBuilder.CreateCall(callee, args, callee->getReturnType()->isVoidTy() ? "" : "calltmp");
+
+    if (printScope)
+        ctx.IRBuilder.CreateCall(ctx.IRModule->getFunction("leaveStringScope"), {printScope});
+
+    return call;
+}
+
+llvm::Value *IRGenerator::generateStrlenCall(FunctionCallNode &node) {
+    llvm::Value *value = node.getParam(0)->accept(*this);
+    if (auto varRef = dynamic_cast<VariableRefNode *>(node.getParam(0))) {
+        if (varRef->isRef())
+            value = symtab.getCurrentScope()->getSymbol(varRef->getValue())->getLlvmValue();
+    }
+
+    std::vector<llvm::Value *> fields;
+    appendStringArgs(value, fields);
+    return ctx.IRBuilder.CreateTrunc(fields[1], llvm::Type::getInt32Ty(ctx.IRContext), "str_len32");
+}
+
+void IRGenerator::appendStringArgs(llvm::Value *value, std::vector<llvm::Value *> &args) {
+    // References and reference parameters are loaded first
+    if (value->getType()->isPointerTy())
+        value = ctx.IRBuilder.CreateLoad(ctx.stringType, value, "str_val");
+
+    args.push_back(ctx.IRBuilder.CreateExtractValue(value, 0, "str_data"));
+    args.push_back(ctx.IRBuilder.CreateExtractValue(value, 1, "str_len"));
 }
 
 llvm::Value *IRGenerator::visit(FunctionCallNode &node) {
+    // The length is part of the string value, strlen is not a runtime function
+    if (node.getValue() == "strlen" && node.getParamsCount() == 1) {
+        return generateStrlenCall(node);
+    }
+
     // Function caller
     llvm::Function *callee = ctx.IRModule->getFunction(node.getValue());
     if (!callee) {
@@ -558,24 +625,33 @@ llvm::Value *IRGenerator::visit(FunctionCallNode &node) {
             llvm::Type *voidTy = llvm::Type::getVoidTy(C);
             llvm::Type *i8PtrTy = llvm::PointerType::get(llvm::Type::getInt8Ty(C), 0);
 
-            // Getting the event id
-            llvm::Value *eventID = ctx.IRBuilder.CreateGlobalStringPtr(node.getValue(), "event_id");
+            // Only the called events are kept in the descriptor table
+            scheduledEvents.insert(node.getValue());
 
-            // Getting the scheduleEventData function from the module
-            llvm::FunctionCallee scheduleFn = ctx.IRModule->getFunction("scheduleEventData");
+            // Getting the event handle
+            llvm::GlobalVariable *handleGlobal = getEventHandle(node.getValue());
+            llvm::Value *handle = ctx.IRBuilder.CreateLoad(handleGlobal->getValueType(), handleGlobal, "event_handle");
 
-            // Creating argv in the stack as void* argv[N]
+            // Inside loops the calls are batched, the runtime activates them together at the loop exit
+            llvm::FunctionCallee scheduleFn =
+                ctx.IRModule->getFunction(loopDepth > 0 ? "batchEventData" : "scheduleEventData");
+            if (loopDepth > 0)
+                batchedCalls = true;
+
+            // Creating argv in the entry block as void* argv[N], so loops reuse the same stack slots
+            llvm::BasicBlock &entryBB = ctx.IRBuilder.GetInsertBlock()->getParent()->getEntryBlock();
+            llvm::IRBuilder<> tmpBuilder(&entryBB, entryBB.begin());
             unsigned argCount = node.getParamsCount();
 
             llvm::Value *argCountV = llvm::ConstantInt::get(llvm::Type::getInt32Ty(C), argCount);
-            llvm::Value *argvAlloca = ctx.IRBuilder.CreateAlloca(i8PtrTy, argCountV, "event_argv");
+            llvm::Value *argvAlloca = tmpBuilder.CreateAlloca(i8PtrTy, argCountV, "event_argv");
 
-            // Filling argv[i] with  &valor_real
+            // Filling argv[i] with  &valor_real, the runtime copies the strings that outlive the current frame
             for (unsigned i = 0; i < argCount; ++i) {
-                llvm::Value *argValue = node.getParam(i)->accept(*this);
+                llvm::Value *argValue = args[i];
 
                 // Always materialize the value into memory so scheduleEventData can copy it safely.
-                llvm::Value *argAddr = ctx.IRBuilder.CreateAlloca(argValue->getType(), nullptr, "arg_tmp");
+                llvm::Value *argAddr = tmpBuilder.CreateAlloca(argValue->getType(), nullptr, "arg_tmp");
                 ctx.IRBuilder.CreateStore(argValue, argAddr);
 
                 llvm::Value *argVoidPtr = ctx.IRBuilder.CreateBitCast(argAddr, i8PtrTy);
@@ -586,27 +662,53 @@ llvm::Value *IRGenerator::visit(FunctionCallNode &node) {
                 ctx.IRBuilder.CreateStore(argVoidPtr, slot);
             }
 
-            // Calling scheduleEventData
-            return ctx.IRBuilder.CreateCall(scheduleFn, {eventID, argvAlloca});
+            // Calling scheduleEventData or batchEventData
+            return ctx.IRBuilder.CreateCall(scheduleFn, {handle, argvAlloca});
         }
     }
 
     // Returns the function call IR
-    return ctx.IRBuilder.CreateCall(callee, args, callee->getReturnType()->isVoidTy() ? "" : "calltmp");
+    llvm::Value *call = ctx.IRBuilder.CreateCall(callee, args, callee->getReturnType()->isVoidTy() ? "" : "calltmp");
+
+    // The strings stored through a reference to a variable of this frame move to its region
+    for (int i = 0; i < node.getParamsCount(); i++) {
+        auto varRef = dynamic_cast<VariableRefNode *>(node.getParam(i));
+        Symbol *symb = varRef ? symtab.getCurrentScope()->getSymbol(varRef->getValue()) : nullptr;
+        if (!symb || !varRef->isRef() || symb->getType() != SupportedTypes::TYPE_STRING)
+            continue;
+
+        auto local = llvm::dyn_cast<llvm::AllocaInst>(symb->getLlvmValue());
+        if (local && local->getFunction() == ctx.IRBuilder.GetInsertBlock()->getParent())
+            ctx.IRBuilder.CreateCall(ctx.IRModule->getFunction("adoptRefString"), {local});
+    }
+
+    return call;
 };
 
 llvm::Value *IRGenerator::visit(ReturnNode &node) {
     llvm::Value *ret = nullptr;
 
+    // A return inside a loop skips its exit, the pending batch is activated here
+    if (loopDepth > 0)
+        ctx.IRBuilder.CreateCall(ctx.IRModule->getFunction("flushEventBatch"));
+
+    // A coroutine body ends through its cleanup block
+    if (coroutine.frame) {
+        ctx.IRBuilder.CreateBr(coroutine.cleanupBB);
+        hasReturned = true;
+        return nullptr;
+    }
+
     // Checks if the return is from a value or void
     if (node.getStmt()) {
         // Generates the return value
-        ret = node.getStmt()->accept(*this);
+        ret = generateFrameExit(node.getStmt()->accept(*this));
 
         // Return IR statement
         ctx.IRBuilder.CreateRet(ret);
     } else {
         // Void return
+        generateFrameExit(nullptr);
         ctx.IRBuilder.CreateRetVoid();
     }
 
@@ -709,10 +811,13 @@ llvm::Value *IRGenerator::visit(WhileNode &node) {
     llvm::BasicBlock *endLoopBB = llvm::BasicBlock::Create(ctx.IRContext, "endLoop", function);
 
     // Break / Continue control
+    LoopContext prevLoop = loopContext;
     loopContext.condBB = condBB;
     loopContext.endLoopBB = endLoopBB;
+    ++loopDepth;
 
     // Jumps to the condition evaluation
+    LoopStrings loopStrings = enterLoopStrings(&node);
     ctx.IRBuilder.CreateBr(condBB);
     ctx.pushFunction(condBB);
 
@@ -720,8 +825,9 @@ llvm::Value *IRGenerator::visit(WhileNode &node) {
     ctx.IRBuilder.CreateCondBr(node.getExpr()->accept(*this), loopBB, endLoopBB);
     ctx.popFunction();
 
-    // Generates the while block
+    // Generates the while block, the strings of the previous iteration are released
     ctx.IRBuilder.SetInsertPoint(loopBB);
+    leaveLoopStrings(loopStrings);
     hasReturned = false;
     node.getCodeBlock()->accept(*this);
     popScope();
@@ -737,9 +843,11 @@ llvm::Value *IRGenerator::visit(WhileNode &node) {
 
     // The code after the loop must be in the end loop block
     ctx.IRBuilder.SetInsertPoint(endLoopBB);
+    endLoop();
+    leaveLoopStrings(loopStrings);
 
-    loopContext.condBB = nullptr;
-    loopContext.endLoopBB = nullptr;
+    // Restores the enclosing loop, if any
+    loopContext = prevLoop;
 
     // Restores previous return state
     hasReturned = prevReturned;
@@ -757,12 +865,14 @@ llvm::Value *IRGenerator::visit(ForNode &node) {
     llvm::BasicBlock *condBB = llvm::BasicBlock::Create(ctx.IRContext, "condition", function);
     llvm::BasicBlock *loopBB = llvm::BasicBlock::Create(ctx.IRContext, "loop", function);
     llvm::BasicBlock *endLoopBB = llvm::BasicBlock::Create(ctx.IRContext, "endLoop", function);
+    LoopContext prevLoop = loopContext;
     loopContext.condBB = condBB;
     loopContext.endLoopBB = endLoopBB;
 
     node.getDef()->accept(*this);
 
     // Jumps to the condition evaluation
+    LoopStrings loopStrings = enterLoopStrings(&node);
     ctx.IRBuilder.CreateBr(condBB);
     ctx.pushFunction(condBB);
 
@@ -770,8 +880,10 @@ llvm::Value *IRGenerator::visit(ForNode &node) {
     ctx.IRBuilder.CreateCondBr(node.getCondition()->accept(*this), loopBB, endLoopBB);
     ctx.popFunction();
 
-    // Generates the for block
+    // Generates the for block, the strings of the previous iteration are released
+    ++loopDepth;
     ctx.pushFunction(loopBB);
+    leaveLoopStrings(loopStrings);
     node.getCodeBlock()->accept(*this);
     popScope();
 
@@ -789,9 +901,11 @@ llvm::Value *IRGenerator::visit(ForNode &node) {
 
     // The code after the loop must be in the end loop block
     ctx.IRBuilder.SetInsertPoint(endLoopBB);
+    endLoop();
+    leaveLoopStrings(loopStrings);
 
-    loopContext.condBB = nullptr;
-    loopContext.endLoopBB = nullptr;
+    // Restores the enclosing loop, if any
+    loopContext = prevLoop;
 
     // Restores previous return state
     hasReturned = prevReturned;
@@ -799,6 +913,89 @@ llvm::Value *IRGenerator::visit(ForNode &node) {
     return nullptr;
 }
 
+/**
+ * @brief Collects the outer string variables that a statement stores, directly or through a reference.
+ * @param node Statement to check, with its nested blocks.
+ * @param outer Scope around the loop.
+ * @param kept Symbols found, each one once.
+ */
+static void collectOuterStrings(ASTNode *node, const std::shared_ptr<Scope> &outer, std::vector<Symbol *> &kept) {
+    if (!node)
+        return;
+
+    // Declarations belong to the iteration, the same name in the body hides the outer one
+    auto keep = [&](const std::string &name) {
+        Symbol *symb = outer->getSymbol(name);
+        if (symb && symb->getType() == SupportedTypes::TYPE_STRING &&
+            std::find(kept.begin(), kept.end(), symb) == kept.end())
+            kept.push_back(symb);
+    };
+
+    if (auto assign = dynamic_cast<VariableAssignNode *>(node)) {
+        if (assign->getType() == SupportedTypes::TYPE_VOID)
+            keep(assign->getValue());
+        collectOuterStrings(assign->getAssign(), outer, kept);
+    } else if (auto call = dynamic_cast<FunctionCallNode *>(node)) {
+        // A string stored through a reference is moved to the region of the caller when the call returns
+        for (int i = 0; i < call->getParamsCount(); ++i) {
+            auto varRef = dynamic_cast<VariableRefNode *>(call->getParam(i));
+            if (varRef && varRef->isRef())
+                keep(varRef->getValue());
+        }
+    } else if (auto block = dynamic_cast<CodeBlockNode *>(node)) {
+        for (int i = 0; i < block->getStmtCount(); ++i) {
+            collectOuterStrings(block->getStmt(i), outer, kept);
+        }
+    } else if (auto ifNode = dynamic_cast<IfNode *>(node)) {
+        collectOuterStrings(ifNode->getCodeBlock(), outer, kept);
+        collectOuterStrings(ifNode->getElseStmt(), outer, kept);
+    } else if (auto elseNode = dynamic_cast<ElseNode *>(node)) {
+        collectOuterStrings(elseNode->getStmt(), outer, kept);
+    } else if (auto whileNode = dynamic_cast<WhileNode *>(node)) {
+        collectOuterStrings(whileNode->getCodeBlock(), outer, kept);
+    } else if (auto forNode = dynamic_cast<ForNode *>(node)) {
+        collectOuterStrings(forNode->getCodeBlock(), outer, kept);
+        collectOuterStrings(forNode->getAssign(), outer, kept);
+    }
+}
+
+IRGenerator::LoopStrings IRGenerator::enterLoopStrings(ASTNode *body) {
+    std::vector<Symbol *> symbols;
+    collectOuterStrings(body, symtab.getCurrentScope(), symbols);
+
+    // Only the variables already in memory, a name declared after the loop is not visible in it
+    LoopStrings strings;
+    for (Symbol *symb : symbols) {
+        llvm::Value *addr = symb->getLlvmValue();
+        if (addr && addr->getType()->isPointerTy())
+            strings.kept.push_back(addr);
+    }
+
+    strings.mark = ctx.IRBuilder.CreateCall(ctx.IRModule->getFunction("enterStringScope"), {}, "loop_scope");
+    return strings;
+}
+
+void IRGenerator::leaveLoopStrings(const LoopStrings &strings) {
+    if (strings.kept.empty()) {
+        ctx.IRBuilder.CreateCall(ctx.IRModule->getFunction("leaveStringScope"), {strings.mark});
+        return;
+    }
+
+    // The values of the outer variables are copied to the start of the region after it is released
+    std::vector<llvm::Value *> args = {strings.mark, ctx.IRBuilder.getInt32(strings.kept.size())};
+    args.insert(args.end(), strings.kept.begin(), strings.kept.end());
+    ctx.IRBuilder.CreateCall(ctx.IRModule->getFunction("leaveStringScopeKeepingVars"), args);
+}
+
+void IRGenerator::endLoop() {
+    if (--loopDepth > 0 || !batchedCalls)
+        return;
+
+    // Every exit of the loop (condition or break) goes through this block
+    ctx.IRBuilder.CreateCall(ctx.IRModule->getFunction("flushEventBatch"));
+    batchedCalls = false;
+}
+
 llvm::Value *IRGenerator::visit(LoopControlStatementNode &node) {
     if (node.getValue() == "continue") {
         // Jumps to the condition
@@ -819,6 +1016,8 @@ auto mapTypeToCode = [](SupportedTypes t) -> int {
         return 2;
     case SupportedTypes::TYPE_STRING:
         return 3;
+    case SupportedTypes::TYPE_PTR:
+        return 4;
     default:
         return 0; // UNKNOWN
     }
@@ -842,7 +1041,7 @@ llvm::Value *IRGenerator::visit(EventNode &node) {
 
     for (int i = 0; i < paramCount; i++) {
         auto *varNode = dynamic_cast<VariableDecNode *>(node.getParam(i));
-        SupportedTypes t = varNode->getType().getSupportedType();
+        SupportedTypes t = varNode->getType().base ? SupportedTypes::TYPE_PTR : varNode->getType().getSupportedType();
 
         int code = mapTypeToCode(t);
 
@@ -867,8 +1066,8 @@ llvm::Value *IRGenerator::visit(EventNode &node) {
         }
     }
 
-    // Event generation
-    llvm::Type *returnType = getLlvmType(SupportedTypes::TYPE_VOID);
+    // Event generation, a coroutine returns its frame handle
+    llvm::Type *returnType = node.isCoroutine() ? i8PtrTy : getLlvmType(SupportedTypes::TYPE_VOID);
     llvm::FunctionType *eventType = llvm::FunctionType::get(returnType, paramTypes, false);
     llvm::Function *event = ctx.IRModule->getFunction(node.getValue());
 
@@ -877,19 +1076,69 @@ llvm::Value *IRGenerator::visit(EventNode &node) {
     }
 
     llvm::Value *eventID = ctx.IRBuilder.CreateGlobalStringPtr(node.getValue(), "event_id");
-    llvm::Value *time = node.getTimeStmt()->accept(*this);
-    llvm::Value *limit = llvm::ConstantInt::get(llvm::Type::getInt32Ty(ctx.IRContext), node.getLimit());
 
-    // Inserting the event register function right after the event
-    llvm::FunctionCallee fn = ctx.IRModule->getFunction("registerEventData");
+    // The runtime activates the event through its typed trampoline
+    llvm::Function *thunk = generateEventThunk(event);
+    llvm::Value *fnPtr = ctx.IRBuilder.CreateBitCast(thunk, i8PtrTy);
+
+    // Constant timed events are registered at startup from the descriptor table
+    llvm::Value *handle = nullptr;
+    if (node.getTimeCommand() != TimeCommand::TIME_WHEN && dynamic_cast<TimeLiteralNode *>(node.getTimeStmt())) {
+        eventDescriptors.push_back({&node, llvm::cast<llvm::Constant>(eventID), thunk, typesGlobal});
+    } else if (node.getTimeCommand() == TimeCommand::TIME_WHEN) {
+        // Inserting the event register function right after the event
+        llvm::FunctionCallee fn = ctx.IRModule->getFunction("registerWhenEventData");
+        handle = ctx.IRBuilder.CreateCall(fn, {eventID, fnPtr}, "event_handle");
+    } else {
+        llvm::Value *time = generateEventPeriod(node.getTimeStmt());
+        llvm::Value *limit = llvm::ConstantInt::get(llvm::Type::getInt32Ty(ctx.IRContext), node.getLimit());
+
+        // `every` events are periodic, `at` and `after` events are single activation timers
+        llvm::Value *command = llvm::ConstantInt::get(i32Ty, node.getTimeCommand());
+        llvm::Value *overrun = llvm::ConstantInt::get(i32Ty, node.getOverrunPolicy());
+        llvm::Value *priority = llvm::ConstantInt::get(i32Ty, node.getPriority());
+        llvm::Value *argCount = llvm::ConstantInt::get(i32Ty, paramCount);
+
+        llvm::FunctionCallee fn = ctx.IRModule->getFunction("registerEventData");
+        handle = ctx.IRBuilder.CreateCall(
+            fn, {eventID, time, fnPtr, argCount, typesPtr, limit, command, overrun, priority}, "event_handle");
+    }
 
-    llvm::Value *fnPtr = ctx.IRBuilder.CreateBitCast(event, i8PtrTy);
+    // The generated code refers to the event by its handle from now on
+    if (handle)
+        ctx.IRBuilder.CreateStore(handle, getEventHandle(node.getValue()));
 
-    ctx.IRBuilder.CreateCall(fn, {eventID, time, fnPtr, llvm::ConstantInt::get(i32Ty, paramCount), typesPtr, limit});
+    // Queued events keep every call until a activation consumes it
+    if (handle && node.getQueueCapacity() > 0) {
+        llvm::Value *capacity = llvm::ConstantInt::get(i32Ty, node.getQueueCapacity());
+        llvm::Value *full = llvm::ConstantInt::get(i32Ty, node.getQueueFullPolicy());
+        ctx.IRBuilder.CreateCall(ctx.IRModule->getFunction("configureEventQueue"), {handle, capacity, full});
+    }
 
-    // Basic block generation and stack push
+    if (handle && node.getSlack()) {
+        llvm::Value *slack = generateEventPeriod(node.getSlack());
+        ctx.IRBuilder.CreateCall(ctx.IRModule->getFunction("configureEventSlack"), {handle, slack});
+    }
+
+    if (handle && node.isAligned())
+        ctx.IRBuilder.CreateCall(ctx.IRModule->getFunction("alignEventPhase"), {handle});
+
+    if (node.getTimeCommand() == TimeCommand::TIME_WHEN) {
+        llvm::Function *condition = generateWhenCondition(node);
+        whenConditions.push_back(condition);
+
+        // Initial value of the condition, later stores to its variables evaluate it again
+        ctx.IRBuilder.CreateCall(condition);
+        for (const std::string &name : node.getTriggers()) {
+            whenTriggers[symtab.getCurrentScope()->getSymbol(name)].push_back(condition);
+        }
+    }
+
+    // Basic block generation and stack push, the runtime releases the strings of each activation
     llvm::BasicBlock *entry = llvm::BasicBlock::Create(ctx.IRContext, "entry", event);
     ctx.pushFunction(entry);
+    llvm::Value *prevStringScope = stringScope;
+    stringScope = nullptr;
 
     // Setting all the params as arguments in their symbol in the symbol table
     unsigned idx = 0;
@@ -904,23 +1153,369 @@ llvm::Value *IRGenerator::visit(EventNode &node) {
     }
     llvm::verifyFunction(*event);
 
+    // Bodies with suspension points are resumed by the runtime from its worker threads
+    CoroutineContext prevCoroutine = coroutine;
+    coroutine = CoroutineContext{};
+    if (node.isCoroutine())
+        generateCoroutineBegin(event);
+
     // IR generation for all the function statements
     node.getCodeBlock()->accept(*this);
 
-    ctx.IRBuilder.CreateRetVoid();
+    if (node.isCoroutine()) {
+        generateCoroutineEnd();
+    } else {
+        ctx.IRBuilder.CreateRetVoid();
+    }
     popScope();
 
     ctx.popFunction();
+    stringScope = prevStringScope;
+    coroutine = prevCoroutine;
 
     return event;
 };
 
+llvm::Function *IRGenerator::generateEventThunk(llvm::Function *event) {
+    llvm::LLVMContext &C = ctx.IRContext;
+    llvm::Type *i8PtrTy = llvm::PointerType::getUnqual(llvm::Type::getInt8Ty(C));
+    llvm::Type *voidTy = llvm::Type::getVoidTy(C);
+
+    // void <event>_thunk(void **argv)
+    llvm::FunctionType *thunkType = llvm::FunctionType::get(voidTy, {i8PtrTy->getPointerTo()}, false);
+    llvm::Function *thunk = llvm::Function::Create(thunkType, llvm::Function::InternalLinkage,
+                                                   event->getName() + "_thunk", ctx.IRModule.get());
+    llvm::Argument *argv = thunk->getArg(0);
+    argv->setName("argv");
+
+    // Independent builder, the insert point of the main builder is not modified
+    llvm::BasicBlock *entry = llvm::BasicBlock::Create(C, "entry", thunk);
+    llvm::IRBuilder<> builder(entry);
+
+    // Loading argv[i] as the type of the i-th parameter
+    std::vector<llvm::Value *> args;
+    for (unsigned i = 0; i < event->arg_size(); ++i) {
+        llvm::Type *argType = event->getFunctionType()->getParamType(i);
+
+        llvm::Value *slot = builder.CreateInBoundsGEP(i8PtrTy, argv, builder.getInt32(i), "slot");
+        llvm::Value *argAddr = builder.CreateLoad(i8PtrTy, slot, "arg_addr");
+        llvm::Value *typedAddr = builder.CreateBitCast(argAddr, argType->getPointerTo());
+
+        args.push_back(builder.CreateLoad(argType, typedAddr, "arg"));
+    }
+
+    // Direct call to the event function
+    builder.CreateCall(event, args);
+    builder.CreateRetVoid();
+
+    llvm::verifyFunction(*thunk);
+    return thunk;
+}
+
+llvm::GlobalVariable *IRGenerator::getEventHandle(const std::string &eventName) {
+    std::string name = eventName + "_handle";
+
+    if (llvm::GlobalVariable *handle = ctx.IRModule->getNamedGlobal(name))
+        return handle;
+
+    // Handle 0 is never valid, schedule and exit calls before the registration are ignored
+    llvm::Type *i64Ty = llvm::Type::getInt64Ty(ctx.IRContext);
+    return new llvm::GlobalVariable(*ctx.IRModule, i64Ty, false, llvm::GlobalValue::InternalLinkage,
+                                    llvm::ConstantInt::get(i64Ty, 0), name);
+}
+
+llvm::Value *IRGenerator::generateEventPeriod(ASTNode *timeStmt) {
+    llvm::Type *i64Ty = llvm::Type::getInt64Ty(ctx.IRContext);
+
+    // Constant periods do not need any conversion code
+    if (auto lit = dynamic_cast<TimeLiteralNode *>(timeStmt)) {
+        return llvm::ConstantInt::get(i64Ty, std::llround(static_cast<double>(lit->getTime()) * 1000.0));
+    }
+
+    // The product is rounded, truncating would turn 0.02 ticks into 19 microseconds
+    llvm::Value *ticks = timeStmt->accept(*this);
+    llvm::Value *wide = ctx.IRBuilder.CreateFPExt(ticks, llvm::Type::getDoubleTy(ctx.IRContext), "ticks_wide");
+    llvm::Value *micros =
+        ctx.IRBuilder.CreateFMul(wide, llvm::ConstantFP::get(wide->getType(), 1000.0), "period_us");
+    micros = ctx.IRBuilder.CreateUnaryIntrinsic(llvm::Intrinsic::round, micros);
+    return ctx.IRBuilder.CreateFPToSI(micros, i64Ty, "period");
+}
+
+llvm::Value *IRGenerator::generateFrameExit(llvm::Value *ret) {
+    if (!stringScope)
+        return ret;
+
+    // A returned string is moved to the region of the caller
+    if (ret && ret->getType() == ctx.stringType && !llvm::isa<llvm::Constant>(ret)) {
+        std::vector<llvm::Value *> args = {stringScope};
+        appendStringArgs(ret, args);
+        return ctx.IRBuilder.CreateCall(ctx.IRModule->getFunction("leaveStringScopeKeeping"), args, "ret_str");
+    }
+
+    ctx.IRBuilder.CreateCall(ctx.IRModule->getFunction("leaveStringScope"), {stringScope});
+    return ret;
+}
+
+void IRGenerator::generateEventTable() {
+    llvm::LLVMContext &C = ctx.IRContext;
+    llvm::Type *i8PtrTy = llvm::PointerType::getUnqual(llvm::Type::getInt8Ty(C));
+    llvm::Type *i32Ty = llvm::Type::getInt32Ty(C);
+    llvm::Type *i64Ty = llvm::Type::getInt64Ty(C);
+
+    // Same layout as EventDescriptor in the runtime main.cpp
+    llvm::StructType *descriptorTy = llvm::StructType::create(C,
+                                                              {
+                                                                  i8PtrTy,               // id
+                                                                  i64Ty,                 // period in microseconds
+                                                                  i8PtrTy,               // thunk
+                                                                  i32Ty->getPointerTo(), // argTypes
+                                                                  i64Ty->getPointerTo(), // handle global
+                                                                  i32Ty,                 // argCount
+                                                                  i32Ty,                 // limit
+                                                                  i32Ty,                 // time command
+                                                                  i32Ty,                 // overrun policy
+                                                                  i32Ty,                 // priority
+                                                                  i32Ty,                 // queue capacity
+                                                                  i32Ty,                 // full-queue policy
+                                                                  i64Ty,                 // slack in microseconds
+                                                                  i32Ty                  // phase aligned flag
+                                                              },
+                                                              "EventDescriptor");
+
+    std::vector<llvm::Constant *> entries;
+    for (const EventDescriptor &descriptor : eventDescriptors) {
+        EventNode *node = descriptor.event;
+
+        // A event without calls is never activated, its registration is dropped
+        if (!scheduledEvents.count(node->getValue()))
+            continue;
+
+        entries.push_back(llvm::ConstantStruct::get(
+            descriptorTy,
+            {descriptor.id,
+             llvm::cast<llvm::Constant>(generateEventPeriod(node->getTimeStmt())),
+             llvm::ConstantExpr::getBitCast(descriptor.thunk, i8PtrTy),
+             llvm::ConstantExpr::getBitCast(descriptor.argTypes, i32Ty->getPointerTo()),
+             getEventHandle(node->getValue()),
+             llvm::ConstantInt::get(i32Ty, node->getParamsCount()),
+             llvm::ConstantInt::get(i32Ty, node->getLimit()),
+             llvm::ConstantInt::get(i32Ty, node->getTimeCommand()),
+             llvm::ConstantInt::get(i32Ty, node->getOverrunPolicy()),
+             llvm::ConstantInt::get(i32Ty, node->getPriority()),
+             llvm::ConstantInt::get(i32Ty, node->getQueueCapacity()),
+             llvm::ConstantInt::get(i32Ty, node->getQueueFullPolicy()),
+             node->getSlack() ? llvm::cast<llvm::Constant>(generateEventPeriod(node->getSlack()))
+                              : llvm::ConstantInt::get(i64Ty, 0),
+             llvm::ConstantInt::get(i32Ty, node->isAligned())}));
+    }
+
+    if (entries.empty())
+        return;
+
+    llvm::ArrayType *tableTy = llvm::ArrayType::get(descriptorTy, entries.size());
+    auto *table = new llvm::GlobalVariable(*ctx.IRModule, tableTy, true, llvm::GlobalValue::PrivateLinkage,
+                                           llvm::ConstantArray::get(tableTy, entries), "event_table");
+
+    // Registered before the first statement of the program, after its stack slots
+    llvm::BasicBlock &entryBB = ctx.IRModule->getFunction("mainLLVM")->getEntryBlock();
+    llvm::BasicBlock::iterator insertPoint = entryBB.begin();
+    while (insertPoint != entryBB.end() && llvm::isa<llvm::AllocaInst>(*insertPoint))
+        ++insertPoint;
+
+    llvm::IRBuilder<> builder(&entryBB, insertPoint);
+    builder.CreateCall(ctx.IRModule->getFunction("registerEventTable"),
+                       {builder.CreateBitCast(table, i8PtrTy), builder.getInt32(entries.size())});
+}
+
+void IRGenerator::generateRealtimeStart() {
+    // First call of the program, after its stack slots
+    llvm::BasicBlock &entryBB = ctx.IRModule->getFunction("mainLLVM")->getEntryBlock();
+    llvm::BasicBlock::iterator insertPoint = entryBB.begin();
+    while (insertPoint != entryBB.end() && llvm::isa<llvm::AllocaInst>(*insertPoint))
+        ++insertPoint;
+
+    llvm::IRBuilder<> builder(&entryBB, insertPoint);
+    builder.CreateCall(ctx.IRModule->getFunction("enableRealtime"));
+}
+
+llvm::Function *IRGenerator::generateWhenCondition(EventNode &node) {
+    llvm::FunctionType *fnTy = llvm::FunctionType::get(llvm::Type::getVoidTy(ctx.IRContext), false);
+    llvm::Function *fn = llvm::Function::Create(fnTy, llvm::GlobalValue::InternalLinkage, node.getValue() + "_when",
+                                                ctx.IRModule.get());
+
+    // Previous state save, the strings of the condition are released before it returns
+    llvm::BasicBlock *savedBB = ctx.IRBuilder.GetInsertBlock();
+    llvm::Value *prevStringScope = stringScope;
+    bool prevInCondition = inWhenCondition;
+    inWhenCondition = true;
+
+    llvm::BasicBlock *entry = llvm::BasicBlock::Create(ctx.IRContext, "entry", fn);
+    ctx.pushFunction(entry);
+    stringScope = ctx.IRBuilder.CreateCall(ctx.IRModule->getFunction("enterStringScope"), {}, "string_scope");
+
+    llvm::Value *cond = node.getCondition()->accept(*this);
+    if (cond) {
+        // Any non zero value is a true condition
+        llvm::Type *i32Ty = llvm::Type::getInt32Ty(ctx.IRContext);
+        if (cond->getType()->isFloatTy()) {
+            cond = ctx.IRBuilder.CreateFCmpONE(cond, llvm::ConstantFP::get(cond->getType(), 0.0), "when_cond");
+        } else if (!cond->getType()->isIntegerTy(1)) {
+            cond = ctx.IRBuilder.CreateICmpNE(cond, llvm::ConstantInt::get(cond->getType(), 0), "when_cond");
+        }
+        llvm::Value *value = ctx.IRBuilder.CreateZExt(cond, i32Ty, "when_value");
+
+        // The runtime activates the event when the condition changes from false to true
+        llvm::GlobalVariable *handleGlobal = getEventHandle(node.getValue());
+        llvm::Value *handle = ctx.IRBuilder.CreateLoad(handleGlobal->getValueType(), handleGlobal, "event_handle");
+
+        llvm::FunctionCallee update = ctx.IRModule->getFunction("updateEventCondition");
+        ctx.IRBuilder.CreateCall(update, {handle, value});
+    }
+
+    ctx.IRBuilder.CreateCall(ctx.IRModule->getFunction("leaveStringScope"), {stringScope});
+    ctx.IRBuilder.CreateRetVoid();
+    ctx.popFunction();
+
+    // Restored previous state
+    if (savedBB)
+        ctx.IRBuilder.SetInsertPoint(savedBB);
+    stringScope = prevStringScope;
+    inWhenCondition = prevInCondition;
+
+    llvm::verifyFunction(*fn);
+    return fn;
+}
+
+llvm::Function *IRGenerator::getWhenUpdate(Symbol *symbol) {
+    llvm::Function *&update = whenUpdates[symbol];
+    if (update)
+        return update;
+
+    // Only declared here, the events that read the variable may be defined later
+    std::string name = symbol ? symbol->getID() + "_changed" : "ref_changed";
+    llvm::FunctionType *fnTy = llvm::FunctionType::get(llvm::Type::getVoidTy(ctx.IRContext), false);
+    update = llvm::Function::Create(fnTy, llvm::GlobalValue::InternalLinkage, name, ctx.IRModule.get());
+    return update;
+}
+
+void IRGenerator::notifyWhenEvents(Symbol *symbol) {
+    if (inWhenCondition)
+        return;
+
+    // A reference may point to any trigger variable
+    if (symbol->isPtr()) {
+        ctx.IRBuilder.CreateCall(getWhenUpdate(nullptr));
+    } else if (symbol->isTrigger()) {
+        ctx.IRBuilder.CreateCall(getWhenUpdate(symbol));
+    }
+}
+
+void IRGenerator::generateWhenUpdates() {
+    for (auto &[symbol, update] : whenUpdates) {
+        const std::vector<llvm::Function *> &conditions = symbol ? whenTriggers[symbol] : whenConditions;
+
+        // No event reads the variable, its stores do not need any call
+        if (conditions.empty()) {
+            for (llvm::User *user : llvm::make_early_inc_range(update->users())) {
+                llvm::cast<llvm::Instruction>(user)->eraseFromParent();
+            }
+            update->eraseFromParent();
+            continue;
+        }
+
+        llvm::IRBuilder<> builder(llvm::BasicBlock::Create(ctx.IRContext, "entry", update));
+        for (llvm::Function *condition : conditions) {
+            builder.CreateCall(condition);
+        }
+        builder.CreateRetVoid();
+    }
+    whenUpdates.clear();
+}
+
 llvm::Value *IRGenerator::visit(ExitNode &node) {
-    llvm::Type *i8PtrTy = llvm::PointerType::getUnqual(llvm::Type::getInt8Ty(ctx.IRContext));
-    llvm::Value *eventID = ctx.IRBuilder.CreateGlobalStringPtr(node.getValue(), "event_id");
-    llvm::Type *voidTy = llvm::Type::getVoidTy(ctx.IRContext);
+    llvm::GlobalVariable *handleGlobal = getEventHandle(node.getValue());
+    llvm::Value *handle = ctx.IRBuilder.CreateLoad(handleGlobal->getValueType(), handleGlobal, "event_handle");
 
     llvm::FunctionCallee fn = ctx.IRModule->getFunction("exitEvent");
 
-    return ctx.IRBuilder.CreateCall(fn, {eventID});
-};
\ No newline at end of file
+    return ctx.IRBuilder.CreateCall(fn, {handle});
+};
+
+void IRGenerator::generateCoroutineBegin(llvm::Function *event) {
+    llvm::LLVMContext &C = ctx.IRContext;
+    llvm::Module *M = ctx.IRModule.get();
+    llvm::PointerType *i8PtrTy = llvm::PointerType::getUnqual(llvm::Type::getInt8Ty(C));
+    llvm::Type *i64Ty = llvm::Type::getInt64Ty(C);
+
+    // The coroutine passes split the function at its suspension points
+    event->setPresplitCoroutine();
+
+    // Frame allocated on the first call, the values live across a suspension point are moved to it
+    llvm::Value *null = llvm::ConstantPointerNull::get(i8PtrTy);
+    coroutine.id = ctx.IRBuilder.CreateCall(llvm::Intrinsic::getDeclaration(M, llvm::Intrinsic::coro_id),
+                                            {ctx.IRBuilder.getInt32(0), null, null, null}, "coro_id");
+    llvm::Function *sizeFn = llvm::Intrinsic::getDeclaration(M, llvm::Intrinsic::coro_size, {i64Ty});
+    llvm::Value *size = ctx.IRBuilder.CreateCall(sizeFn, {}, "coro_size");
+    llvm::Value *memory = ctx.IRBuilder.CreateCall(M->getFunction("malloc"), {size}, "coro_mem");
+    coroutine.frame = ctx.IRBuilder.CreateCall(llvm::Intrinsic::getDeclaration(M, llvm::Intrinsic::coro_begin),
+                                               {coroutine.id, memory}, "coro_frame");
+
+    // Targets of the suspension points, inserted after the body
+    coroutine.cleanupBB = llvm::BasicBlock::Create(C, "coro_cleanup");
+    coroutine.suspendBB = llvm::BasicBlock::Create(C, "coro_suspend");
+
+    // The strings of the body are kept by the event while it is suspended
+    ctx.IRBuilder.CreateCall(M->getFunction("beginEventCoroutine"));
+}
+
+void IRGenerator::generateCoroutineEnd() {
+    llvm::LLVMContext &C = ctx.IRContext;
+    llvm::Module *M = ctx.IRModule.get();
+    llvm::Function *event = ctx.IRBuilder.GetInsertBlock()->getParent();
+
+    // End of the body
+    if (!ctx.IRBuilder.GetInsertBlock()->getTerminator())
+        ctx.IRBuilder.CreateBr(coroutine.cleanupBB);
+
+    // Reached at the end of the body or when the runtime destroys a suspended frame
+    coroutine.cleanupBB->insertInto(event);
+    ctx.IRBuilder.SetInsertPoint(coroutine.cleanupBB);
+    llvm::Value *memory = ctx.IRBuilder.CreateCall(llvm::Intrinsic::getDeclaration(M, llvm::Intrinsic::coro_free),
+                                                   {coroutine.id, coroutine.frame}, "coro_free");
+    ctx.IRBuilder.CreateCall(M->getFunction("free"), {memory});
+    ctx.IRBuilder.CreateBr(coroutine.suspendBB);
+
+    // Return to the runtime, after the first suspension the handle is the frame to resume
+    coroutine.suspendBB->insertInto(event);
+    ctx.IRBuilder.SetInsertPoint(coroutine.suspendBB);
+    ctx.IRBuilder.CreateCall(llvm::Intrinsic::getDeclaration(M, llvm::Intrinsic::coro_end),
+                             {coroutine.frame, ctx.IRBuilder.getFalse(), llvm::ConstantTokenNone::get(C)});
+    ctx.IRBuilder.CreateRet(coroutine.frame);
+}
+
+llvm::Value *IRGenerator::visit(SuspendNode &node) {
+    // Only the event bodies can be suspended, checked by the semantic analysis
+    if (!coroutine.frame)
+        return nullptr;
+
+    llvm::LLVMContext &C = ctx.IRContext;
+    llvm::Module *M = ctx.IRModule.get();
+    llvm::Function *event = ctx.IRBuilder.GetInsertBlock()->getParent();
+
+    // The runtime resumes the frame after the wait time, a `yield` resumes it as soon as a worker is free
+    llvm::Value *delay = node.getTimeStmt() ? generateEventPeriod(node.getTimeStmt())
+                                            : llvm::ConstantInt::get(llvm::Type::getInt64Ty(C), 0);
+    ctx.IRBuilder.CreateCall(M->getFunction("suspendEvent"), {coroutine.frame, delay});
+
+    // 0 resumes the body, 1 destroys the frame, any other value returns to the runtime
+    llvm::Value *state =
+        ctx.IRBuilder.CreateCall(llvm::Intrinsic::getDeclaration(M, llvm::Intrinsic::coro_suspend),
+                                 {llvm::ConstantTokenNone::get(C), ctx.IRBuilder.getFalse()}, "suspend_state");
+    llvm::BasicBlock *resumeBB = llvm::BasicBlock::Create(C, "resume", event);
+    llvm::SwitchInst *resumeSwitch = ctx.IRBuilder.CreateSwitch(state, coroutine.suspendBB, 2);
+    resumeSwitch->addCase(ctx.IRBuilder.getInt8(0), resumeBB);
+    resumeSwitch->addCase(ctx.IRBuilder.getInt8(1), coroutine.cleanupBB);
+
+    ctx.IRBuilder.SetInsertPoint(resumeBB);
+    return nullptr;
+}
@@ -13,6 +13,8 @@
 #include "AST.h"
 #include "CodegenContext.h"
 #include "SymbolTable.h"
+#include <unordered_map>
+#include <unordered_set>
 
 class LiteralNode;
 class BinaryExprNode;
@@ -34,6 +36,7 @@ class IRGenerator {
     int scopeRef = -1;                     /// The scope is -1 before the main program initialization
     std::vector<CompilerError> &errorList; /// List of language misuses
     bool hasReturned = false;              /// Early and nested return control flag
+    llvm::Value *stringScope = nullptr;    /// String region of the current function, null in main and events
 
     /**
      * @brief Matches the condition and end of a loop.
@@ -46,6 +49,58 @@ class IRGenerator {
     };
     LoopContext loopContext;
 
+    /// String region of a loop, released at the start of each iteration and after the loop.
+    struct LoopStrings {
+        llvm::Value *mark;               /// Start of the region
+        std::vector<llvm::Value *> kept; /// Outer string variables stored in the loop, moved out of the region
+    };
+
+    /**
+     * @brief Coroutine of the event body being generated.
+     *
+     * Every suspension point branches to the shared cleanup block when the frame is destroyed.
+     */
+    struct CoroutineContext {
+        llvm::Value *id = nullptr;             /// Token of llvm.coro.id
+        llvm::Value *frame = nullptr;          /// Frame handle, null outside of a coroutine body
+        llvm::BasicBlock *cleanupBB = nullptr; /// Frees the frame
+        llvm::BasicBlock *suspendBB = nullptr; /// Returns to the caller of the ramp or resume function
+    };
+    CoroutineContext coroutine;
+
+    /// Number of loops around the current statement, event calls inside loops are batched.
+    unsigned loopDepth = 0;
+
+    /// Set when a batched event call is generated, the outermost loop flushes the batch at its exit.
+    bool batchedCalls = false;
+
+    /**
+     * @brief Conditions of the `when` events.
+     *
+     * Each condition is a function that reads its variables from static storage, called
+     * after every store to one of them. The stores call a update function per variable,
+     * so they can be generated before the events that read it.
+     */
+    std::vector<llvm::Function *> whenConditions; /// Condition functions, in definition order
+    std::unordered_map<Symbol *, std::vector<llvm::Function *>> whenTriggers; /// Condition functions by variable
+    std::unordered_map<Symbol *, llvm::Function *> whenUpdates; /// Update functions, nullptr for stores by reference
+    bool inWhenCondition = false; /// Set while a condition is generated, its own stores do not update it
+
+    /**
+     * @brief Registration data of a event with a constant period.
+     *
+     * These events are not registered where they are defined, they are emitted in
+     * the descriptor table once the whole program has been generated.
+     */
+    struct EventDescriptor {
+        EventNode *event;
+        llvm::Constant *id;
+        llvm::Function *thunk;
+        llvm::GlobalVariable *argTypes;
+    };
+    std::vector<EventDescriptor> eventDescriptors;   /// Events with a constant period, in definition order
+    std::unordered_set<std::string> scheduledEvents; /// Events with at least one call
+
   public:
     /**
      * @brief IRGenerator constructor.
@@ -164,6 +219,20 @@ class IRGenerator {
      */
     llvm::Value *generatePrintCall(FunctionCallNode &node);
 
+    /**
+     * @brief Built-in strlen call, reads the length of the string without a runtime call.
+     * @param node Node with a "strlen" function call.
+     * @return i32 length of the string.
+     */
+    llvm::Value *generateStrlenCall(FunctionCallNode &node);
+
+    /**
+     * @brief Splits a string value in the data and length arguments of a runtime call.
+     * @param value `%TString` value, or a reference to one.
+     * @param args Call arguments where the two fields are appended.
+     */
+    void appendStringArgs(llvm::Value *value, std::vector<llvm::Value *> &args);
+
     /**
      * @brief Visit a function call node.
      * @param node Node to be visited.
@@ -219,6 +288,127 @@ class IRGenerator {
      */
     llvm::Value *visit(EventNode &node);
 
+    /**
+     * @brief Generates the trampoline used by the runtime to activate a event.
+     *
+     * The `<event>_thunk(void **argv)` function loads every typed argument from
+     * its argv slot and calls the event function directly.
+     *
+     * @param event Event function with its typed parameters.
+     * @return Trampoline function.
+     */
+    llvm::Function *generateEventThunk(llvm::Function *event);
+
+    /**
+     * @brief Gets the global that stores the runtime handle of a event.
+     *
+     * The `<event>_handle` global is set by registerEventData (or registerEventTable)
+     * and read by the schedule and exit calls, created on first use.
+     *
+     * @param eventName Name of the event.
+     * @return Handle global of the event.
+     */
+    llvm::GlobalVariable *getEventHandle(const std::string &eventName);
+
+    /**
+     * @brief Generates the period of a event in microseconds, as expected by registerEventData.
+     *
+     * Time values are float ticks (milliseconds), literals are converted at compile
+     * time and variables are rounded to the nearest microsecond at run time.
+     *
+     * @param timeStmt Time literal or time variable of the event.
+     * @return i64 amount of microseconds.
+     */
+    llvm::Value *generateEventPeriod(ASTNode *timeStmt);
+
+    /**
+     * @brief Releases the string region of the current function before a return.
+     * @param ret Returned value, can be nullptr.
+     * @return Value to return, a returned string is moved to the region of the caller.
+     */
+    llvm::Value *generateFrameExit(llvm::Value *ret);
+
+    /**
+     * @brief Generates the descriptor table of the events with a constant period.
+     *
+     * The table is a constant array read by the runtime in place, registered with a
+     * single call at the start of `mainLLVM`. Events that are never called are left out.
+     * Must be called after the whole AST has been visited.
+     */
+    void generateEventTable();
+
+    /**
+     * @brief Generates the bodies of the update functions of the `when` events.
+     *
+     * Each one calls the conditions that read its variable, the one of the stores through a
+     * reference calls every condition. Update functions without conditions are removed
+     * along with their calls. Must be called after the whole AST has been visited.
+     */
+    void generateWhenUpdates();
+
+    /**
+     * @brief Enables the real-time mode of the runtime at the start of `mainLLVM`.
+     *
+     * Must be called after generateEventTable(), so the memory is locked before the events are registered.
+     */
+    void generateRealtimeStart();
+
+    /**
+     * @brief Leaves a loop, the outermost one activates the events batched inside it.
+     *
+     * Must be called with the insert point at the start of the block after the loop.
+     */
+    void endLoop();
+
+    /**
+     * @brief Starts the string region of a loop, released at the start of each iteration and after the loop.
+     *
+     * Must be called in the scope around the loop, before the jump to its condition. The strings
+     * that the loop stores in variables declared outside of it are moved out of the region.
+     *
+     * @param body Statements executed in each iteration.
+     * @return Region of the loop.
+     */
+    LoopStrings enterLoopStrings(ASTNode *body);
+
+    /**
+     * @brief Releases the strings created since the start of a loop region, keeping the outer variables.
+     * @param strings Region returned by enterLoopStrings.
+     */
+    void leaveLoopStrings(const LoopStrings &strings);
+
+    /**
+     * @brief Generates the function that evaluates the condition of a `when` event and sends it to the runtime.
+     *
+     * Must be called in the scope of the event definition, so the variables the
+     * condition reads are not hidden by the ones of the current scope.
+     *
+     * @param node `when` event.
+     * @return Condition function.
+     */
+    llvm::Function *generateWhenCondition(EventNode &node);
+
+    /**
+     * @brief Gets the function called after the stores to a variable, its body is generated at the end.
+     * @param symbol Stored variable, nullptr for a store through a reference.
+     * @return Update function.
+     */
+    llvm::Function *getWhenUpdate(Symbol *symbol);
+
+    /**
+     * @brief Re-evaluates the conditions of the `when` events triggered by a variable.
+     * @param symbol Variable that has been stored.
+     */
+    void notifyWhenEvents(Symbol *symbol);
+
+    /**
+     * @brief Creates the storage of a declared variable.
+     * @param symbol Declared variable, a trigger of a `when` event is a internal global.
+     * @param type LLVM type of the variable.
+     * @return Address of the variable.
+     */
+    llvm::Value *createVariable(Symbol *symbol, llvm::Type *type);
+
     /**
      * @brief Visits a exit statement node.
      * @param node Node to be visited.
@@ -226,6 +416,22 @@ class IRGenerator {
      */
     llvm::Value *visit(ExitNode &node);
 
+    /**
+     * @brief Visits a `wait` or `yield` statement, a suspension point of the event coroutine.
+     * @param node Node to be visited.
+     * @return llvm::Value* Value obtained from the visit.
+     */
+    llvm::Value *visit(SuspendNode &node);
+
+    /**
+     * @brief Turns the event function into a coroutine, allocating its frame at the start of the body.
+     * @param event Event function, its entry block must be the insert point.
+     */
+    void generateCoroutineBegin(llvm::Function *event);
+
+    /// Ends the body of a coroutine event, the frame is freed and the blocks shared by the suspension points added.
+    void generateCoroutineEnd();
+
     llvm::Value *visitRValue(VariableRefNode &);
     llvm::Value *visitLValue(VariableRefNode &);
 };
\ No newline at end of file
@@ -273,6 +273,10 @@ void Compiler::analyze() {
 void Compiler::generateIR() {
     CodegenContext &ctx = IRgen.get()->getContext();
     getAST()->accept(*IRgen);
+    IRgen->generateWhenUpdates();
+    IRgen->generateEventTable();
+    if (flags.realtime)
+        IRgen->generateRealtimeStart();
 
     // Debug IR print
     if (flags.debug) {
@@ -291,6 +295,19 @@ void Compiler::generateIR() {
 void Compiler::optimize() {
     CodegenContext &ctx = IRgen.get()->getContext();
 
+    // LLVM default optimization pipeline equivalent with a -O2 level.
+    runPipeline(llvm::OptimizationLevel::O2);
+    optimized = true;
+
+    if (flags.debug) {
+        spdlog::debug("****** OPTIMIZED LLVM IR ******");
+        ctx.IRModule->print(llvm::outs(), nullptr);
+    }
+}
+
+void Compiler::runPipeline(llvm::OptimizationLevel level) {
+    CodegenContext &ctx = IRgen.get()->getContext();
+
     // PassBuilder setup
     llvm::PassBuilder passBuilder;
 
@@ -308,16 +325,13 @@ void Compiler::optimize() {
     // Enable analysis sharing between different IR levels
     passBuilder.crossRegisterProxies(LAM, FAM, CGAM, MAM);
 
-    // LLVM default optimization pipeline equivalent with a -O2 level.
-    llvm::ModulePassManager MPM = passBuilder.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::O2);
+    // The O0 pipeline only contains the passes the backend needs, like the coroutine splitting
+    llvm::ModulePassManager MPM = level == llvm::OptimizationLevel::O0
+                                      ? passBuilder.buildO0DefaultPipeline(level)
+                                      : passBuilder.buildPerModuleDefaultPipeline(level);
 
     // Optimization passes
     MPM.run(*ctx.IRModule, MAM);
-
-    if (flags.debug) {
-        spdlog::debug("****** OPTIMIZED LLVM IR ******");
-        ctx.IRModule->print(llvm::outs(), nullptr);
-    }
 }
 
 void Compiler::generateObjectCode() {
@@ -342,6 +356,10 @@ void Compiler::generateObjectCode() {
     ctx.IRModule.get()->setDataLayout(targetMachine->createDataLayout());
     ctx.IRModule->setTargetTriple(targetTriple);
 
+    // Coroutine event bodies can not be emitted before they are split
+    if (!optimized && ctx.IRModule->getFunction("llvm.coro.begin"))
+        runPipeline(llvm::OptimizationLevel::O0);
+
     // Object file destination
     std::error_code EC;
     llvm::raw_fd_ostream dest((execPath / (flags.outputFile + ".o")).string(), EC, llvm::sys::fs::OF_None);
@@ -361,9 +379,13 @@ void Compiler::linkObjectFile() {
 
     // Runtime and program linkage
     std::string command = "clang++ -no-pie " + q(execPath / "main.o") + " " + q(execPath / "TLib.o") + " " +
-                          q(execPath / "Runtime.o") + " " + q(execPath / "Event.o") + " " +
+                          q(execPath / "Runtime.o") + " " + q(execPath / "Scheduler.o") + " " +
+                          q(execPath / "EventRegistry.o") + " " + q(execPath / "Histogram.o") + " " +
+                          q(execPath / "Event.o") + " " + q(execPath / "Trace.o") + " " +
+                          q(execPath / "ArgQueue.o") + " " + q(execPath / "Output.o") + " " +
+                          q(execPath / "StringArena.o") + " " + q(execPath / "Realtime.o") + " " +
                           q(execPath / (flags.outputFile + ".o")) + " -o " +
-                          q(std::filesystem::current_path() / flags.outputFile) + " -pthread -lffi -lspdlog -lfmt";
+                          q(std::filesystem::current_path() / flags.outputFile) + " -pthread -lspdlog -lfmt";
 
     // Link error report
     int linkStatus = std::system(command.c_str());
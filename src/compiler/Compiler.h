@@ -82,6 +82,14 @@ class Compiler {
 
     std::filesystem::path execPath; ///< Execution path of the compiler
 
+    bool optimized = false; ///< The optimization pipeline already lowered the coroutines
+
+    /**
+     * @brief Runs a LLVM pass pipeline over the module.
+     * @param level Optimization level, O0 only runs the mandatory passes (coroutine lowering).
+     */
+    void runPipeline(llvm::OptimizationLevel level);
+
   public:
     /**
      * @brief Compiler default constructor.
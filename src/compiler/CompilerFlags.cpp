@@ -53,6 +53,11 @@ CompilerFlags argvToFlags(int argc, char **argv) {
         .default_value(true)
         .implicit_value(false);
 
+    program.add_argument("--realtime")
+        .help("Locks the memory and prioritizes the event threads of the program at startup.")
+        .default_value(false)
+        .implicit_value(true);
+
     program.add_argument("-IR").help("Generates a LLVM IR file given a file name.").default_value(std::string("ir.ll"));
 
     // If the arguments are invalid throws std::invalid_argument exception
@@ -69,6 +74,7 @@ CompilerFlags argvToFlags(int argc, char **argv) {
     flags.visualizeAST = program.get<bool>("--visualizeAST");
     flags.debug = program.get<bool>("--debug");
     flags.optimization = program.get<bool>("--basic");
+    flags.realtime = program.get<bool>("--realtime");
 
     if (program.is_used("-IR")) {
         std::string irName = program.get<std::string>("-IR");
@@ -18,6 +18,7 @@ struct CompilerFlags {
     bool visualizeAST = false;
     bool debug = false;
     bool optimization = true;
+    bool realtime = false;
 };
 
 /**
@@ -41,6 +42,7 @@ std::string readFile(const std::string &);
  *   - `--visualizeAST`   -> Sets visualize flag to true.
  *   - `--debug`          -> Sets the debug flag to true.
  *   - `--basic`          -> Sets the debug optimization flag to false.
+ *   - `--realtime`       -> Starts the program in the low-latency real-time mode.
  *   - `-IR IRfile`       -> Generates a file with the LLVM IR code.
  *   - `-h / --help`      -> Prints the compiler's help.
  *
@@ -20,9 +20,22 @@ EVERY : 'every' ;
 AT    : 'at'    ;
 AFTER : 'after' ;
 LIMIT : 'limit' ;
+OVERRUN  : 'overrun'  ;
+SKIP     : 'skip'     ;
+CATCHUP  : 'catchup'  ;
+COALESCE : 'coalesce' ;
+PRIORITY : 'priority' ;
+SLACK    : 'slack'    ;
+ALIGNED  : 'aligned'  ;
+QUEUE      : 'queue'      ;
+BLOCK      : 'block'      ;
+DROPOLDEST : 'dropoldest' ;
+DROPNEWEST : 'dropnewest' ;
 WHEN  : 'when'  ;
 EXIT  : 'exit'  ;
 EVENT : 'event' ;
+WAIT  : 'wait'  ;
+YIELD : 'yield' ;
 
 // Types
 TYPE_INT     : 'int'    ;
@@ -37,6 +50,7 @@ TYPE_TIME    : 'time'   ;
 BOOL_TRUE_LITERAL  : 'true'  ;
 BOOL_FALSE_LITERAL : 'false' ;
 
+TIME_US   : 'us'   ;
 TIME_TICK : 'tick' ;
 TIME_SEC  : 'sec'  ;
 TIME_MIN  : 'min'  ;
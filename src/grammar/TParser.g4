@@ -23,6 +23,7 @@ stmt
 	| loop 
 	| expr SEMICOLON
 	| eventDef
+	| suspendStmt
 	;
 
 expr
@@ -44,9 +45,9 @@ comparisonOperator
 
 operand
 	: literal
-	| IDENTIFIER(INC | DEC)?
-	| (INC | DEC)IDENTIFIER
-	| TYPE_PTR IDENTIFIER
+	| identifier(INC | DEC)?
+	| (INC | DEC)identifier
+	| TYPE_PTR identifier
 	| functionCall
 	;
 
@@ -60,20 +61,20 @@ literal
 	| boolean_literal
    	;
 
-variableDec: type IDENTIFIER ;
+variableDec: type identifier ;
 
 variableAssign 
-	: IDENTIFIER ASSIGN_OPERATOR expr
+	: identifier ASSIGN_OPERATOR expr
 	| variableDec ASSIGN_OPERATOR expr
 	;
 
-functionDefinition: type FUNCTION IDENTIFIER LPAREN params? RPAREN block ;
+functionDefinition: type FUNCTION identifier LPAREN params? RPAREN block ;
 
-functionDeclaration: type FUNCTION IDENTIFIER LPAREN params? RPAREN  ;
+functionDeclaration: type FUNCTION identifier LPAREN params? RPAREN  ;
 
-functionCall: IDENTIFIER LPAREN (expr (COMMA expr)*)? RPAREN ;
+functionCall: identifier LPAREN (expr (COMMA expr)*)? RPAREN ;
 
-params: paramType IDENTIFIER (COMMA paramType IDENTIFIER)* ;
+params: paramType identifier (COMMA paramType identifier)* ;
 
 if: IF LPAREN expr RPAREN block (ELSE else)?;
 
@@ -114,6 +115,21 @@ paramType
 	| TYPE_PTR type
 	;
 
+/* The event modifiers and `us` are only keywords after a time amount or in a event definition,
+   they can still name variables and functions */
+identifier
+	: IDENTIFIER
+	| OVERRUN
+	| SKIP
+	| CATCHUP
+	| COALESCE
+	| QUEUE
+	| BLOCK
+	| DROPOLDEST
+	| DROPNEWEST
+	| TIME_US
+	;
+
 boolean_literal 
 				: BOOL_TRUE_LITERAL
 				| BOOL_FALSE_LITERAL
@@ -122,15 +138,16 @@ boolean_literal
 time_literal : (FLOAT_LITERAL | NUMBER_LITERAL) timeStamp ;
 
 timeStamp 
-		: TIME_TICK
+		: TIME_US
+		| TIME_TICK
 		| TIME_SEC
 		| TIME_MIN
 		| TIME_HR
 		;
 
 eventDef
-	: EVENT IDENTIFIER (LPAREN params RPAREN)? timeCommand (time_literal | IDENTIFIER) (eventLimitCondition)? eventBlock
-	| EVENT IDENTIFIER WHEN expr eventBlock
+	: EVENT identifier (LPAREN params RPAREN)? timeCommand (time_literal | identifier) (eventLimitCondition)? (eventOverrunPolicy)? (eventPriority)? (eventSlack)? (ALIGNED)? (eventQueue)? eventBlock
+	| EVENT identifier WHEN expr eventBlock
 	;
 
 timeCommand
@@ -141,6 +158,19 @@ timeCommand
 
 eventLimitCondition : LIMIT NUMBER_LITERAL ;
 
+eventOverrunPolicy : OVERRUN (SKIP | CATCHUP | COALESCE) ;
+
+eventPriority : PRIORITY NUMBER_LITERAL ;
+
+eventSlack : SLACK time_literal ;
+
+eventQueue : QUEUE NUMBER_LITERAL (BLOCK | DROPOLDEST | DROPNEWEST)? ;
+
 eventBlock : LBRACE (stmt | exitStmt)* RBRACE ;
 
-exitStmt : EXIT IDENTIFIER SEMICOLON ;
\ No newline at end of file
+exitStmt : EXIT identifier SEMICOLON ;
+
+suspendStmt
+	: WAIT (time_literal | identifier) SEMICOLON
+	| YIELD SEMICOLON
+	;
\ No newline at end of file
@@ -0,0 +1,61 @@
+#include "ArgQueue.h"
+#include <algorithm>
+
+ArgQueue::ArgQueue(std::size_t capacity, int width)
+    : capacity(std::max<std::size_t>(1, capacity)), width(width),
+      turns(std::make_unique<std::atomic<std::uint64_t>[]>(this->capacity)),
+      words(std::make_unique<std::uint64_t[]>(this->capacity * static_cast<std::size_t>(width))) {
+    // Cell i is free for the producer of position i, turns are doubled so a written cell never looks free
+    for (std::size_t i = 0; i < this->capacity; ++i) {
+        turns[i].store(2 * i, std::memory_order_relaxed);
+    }
+}
+
+bool ArgQueue::tryPush(const std::uint64_t *tuple) {
+    std::uint64_t pos = head.load(std::memory_order_relaxed);
+
+    while (true) {
+        std::size_t cell = pos % capacity;
+        std::uint64_t turn = turns[cell].load(std::memory_order_acquire);
+
+        if (turn == 2 * pos) {
+            // The cell is free, claiming the position
+            if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                std::copy(tuple, tuple + width, &words[cell * width]);
+                turns[cell].store(2 * pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (turn < 2 * pos) {
+            // The cell still holds the tuple of the previous lap
+            return false;
+        } else {
+            pos = head.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool ArgQueue::tryPop(std::uint64_t *tuple) {
+    std::uint64_t pos = tail.load(std::memory_order_relaxed);
+
+    while (true) {
+        std::size_t cell = pos % capacity;
+        std::uint64_t turn = turns[cell].load(std::memory_order_acquire);
+
+        if (turn == 2 * pos + 1) {
+            // The cell has been written, claiming the position
+            if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                if (tuple)
+                    std::copy(&words[cell * width], &words[cell * width] + width, tuple);
+
+                // Free for the producer of the next lap
+                turns[cell].store(2 * (pos + capacity), std::memory_order_release);
+                return true;
+            }
+        } else if (turn < 2 * pos + 1) {
+            // Nothing written at this position yet
+            return false;
+        } else {
+            pos = tail.load(std::memory_order_relaxed);
+        }
+    }
+}
@@ -0,0 +1,57 @@
+/**
+ * @file ArgQueue.h
+ * @brief Contains the definition of the bounded argument queue of the queued events.
+ *
+ * Each element is a argument tuple of a fixed number of words. The queue is a
+ * lock-free ring (Vyukov's bounded MPMC queue): every cell has a sequence number
+ * that tells producers and consumers whose turn it is, so the only shared writes
+ * are one CAS on the head or the tail per operation.
+ *
+ * @author Adrián Zamora Sánchez
+ * @see Event.h
+ */
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/// Bounded lock-free queue of argument tuples, safe for any number of producers and consumers.
+class ArgQueue {
+    std::size_t capacity;                                ///< Number of cells
+    int width;                                           ///< Words per tuple
+    std::unique_ptr<std::atomic<std::uint64_t>[]> turns; ///< Sequence of each cell, 2 * position free, + 1 written
+    std::unique_ptr<std::uint64_t[]> words;              ///< Tuples, `width` words per cell
+
+    alignas(64) std::atomic<std::uint64_t> head{0}; ///< Next position to write
+    alignas(64) std::atomic<std::uint64_t> tail{0}; ///< Next position to read
+
+  public:
+    /**
+     * @brief Queue constructor.
+     * @param capacity Maximum number of queued tuples.
+     * @param width Words of each tuple.
+     */
+    ArgQueue(std::size_t capacity, int width);
+
+    /**
+     * @brief Appends a tuple.
+     * @param tuple `width` words to copy.
+     * @return `false` if the queue is full.
+     */
+    bool tryPush(const std::uint64_t *tuple);
+
+    /**
+     * @brief Removes the oldest tuple.
+     * @param tuple Destination of the `width` words, can be nullptr to discard them.
+     * @return `false` if the queue is empty.
+     */
+    bool tryPop(std::uint64_t *tuple);
+
+    /**
+     * @brief Getter for the capacity.
+     * @return Maximum number of queued tuples.
+     */
+    std::size_t getCapacity() const { return capacity; }
+};
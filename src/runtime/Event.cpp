@@ -1,23 +1,46 @@
 
 #include "Event.h"
-#include <ffi.h>
+#include "StringArena.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
 #include <iostream>
 #include <stdexcept>
+#include <utility>
 
-using EventFn = void (*)();
+/// CPU time consumed by the calling thread.
+static std::chrono::nanoseconds threadCpuTime() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+}
 
-Event::Event(std::string id, float t, EventFn fnPtr, int argCount, const int *argTypesIn, int limit)
-    : id(std::move(id)), ticks(static_cast<int>(std::ceil(t))), execLimit(limit), fnPtr(fnPtr), argCount(argCount),
-      argTypes(argTypesIn, argTypesIn + argCount), argv(argCount, nullptr) {}
+/// Bytes of the chunks of the event arenas, a suspended event usually keeps a few short strings.
+static constexpr std::size_t EVENT_CHUNK_SIZE = 1024;
 
-Event::~Event() {
-    running.store(false);
+/// Event whose body is running in the calling thread.
+static thread_local Event *currentEvent = nullptr;
 
-    // Detach to prevent abortion
-    if (worker.joinable())
-        worker.join();
+/**
+ * @brief Calls one of the functions stored at the start of a coroutine frame.
+ * @param frame Coroutine frame, its first word resumes the body and the second one destroys it.
+ * @param index 0 to resume, 1 to destroy.
+ */
+static void callFrame(void *frame, int index) {
+    using FrameFn = void (*)(void *);
+    reinterpret_cast<FrameFn>(static_cast<void **>(frame)[index])(frame);
 }
 
+/// Type code of the string parameters, same value as the compiler.
+static constexpr int STRING_CODE = 3;
+
+/// Words of a string slot: data, length and the inline bytes of the short strings.
+static constexpr int STRING_WORDS = 4;
+
+/// Longest string stored inside its slot, the terminator included it fills the last two words.
+static constexpr std::int64_t INLINE_LENGTH = (STRING_WORDS - 2) * sizeof(std::uint64_t) - 1;
+
 static size_t typeSize(int code) {
     switch (code) {
     case 1:
@@ -25,113 +48,562 @@ static size_t typeSize(int code) {
     case 2:
         return sizeof(float); // TYPE_FLOAT
     case 3:
-        return sizeof(void *); // TYPE_STRING & PTR
+        return sizeof(TString); // TYPE_STRING
+    case 4:
+        return sizeof(void *); // Reference parameters
     default:
         return sizeof(void *);
     }
 }
 
-static ffi_type *codeToFFI(int code) {
-    switch (code) {
-    case 1:
-        return &ffi_type_sint32;
-    case 2:
-        return &ffi_type_float;
-    case 3:
-        return &ffi_type_pointer;
-    default:
-        return &ffi_type_pointer;
+Event::Event(const char *id,
+             std::chrono::microseconds period,
+             EventThunk thunk,
+             int argCount,
+             const int *argTypes,
+             int limit,
+             EventKind kind)
+    : period(period), execLimit(limit), thunk(thunk), kind(kind), repeat(kind == EventKind::EVERY), id(id),
+      argCount(argCount), argTypes(argTypes), argOffsets(argCount, 0), argv(argCount, nullptr) {
+    // A word per argument, strings take a whole slot
+    for (int i = 0; i < argCount; ++i) {
+        argOffsets[i] = wordCount;
+        wordCount += argTypes[i] == STRING_CODE ? STRING_WORDS : 1;
+    }
+
+    publishedArgs = std::make_unique<std::atomic<std::uint64_t>[]>(wordCount);
+    activeArgs.assign(wordCount, 0);
+    hasStrings = std::find(argTypes, argTypes + argCount, STRING_CODE) != argTypes + argCount;
+
+    // The thunk reads each argument from the start of its snapshot slot
+    for (int i = 0; i < argCount; ++i) {
+        argv[i] = &activeArgs[argOffsets[i]];
     }
 }
 
-void Event::setArgsCopy(void **incoming) {
-    std::lock_guard<std::mutex> lock(argsMutex);
+Event::~Event() {
+    if (!hasStrings)
+        return;
 
-    // Checking the sizes
-    if ((int)argv.size() != argCount)
-        argv.assign(argCount, nullptr);
+    // The activations have finished, the published and queued tuples are the only owners left
+    std::vector<std::uint64_t> tuple(wordCount);
+    for (int i = 0; i < wordCount; ++i) {
+        tuple[i] = publishedArgs[i].load(std::memory_order_relaxed);
+    }
+    freeStrings(tuple.data());
+    reclaimStrings();
 
-    if ((int)ownedArgs.size() != argCount)
-        ownedArgs.assign(argCount, {});
+    while (queue && queue->tryPop(tuple.data())) {
+        freeStrings(tuple.data());
+    }
+}
 
+void Event::checkArgs(void **incoming) const {
     for (int i = 0; i < argCount; ++i) {
         if (!incoming[i]) {
             throw std::runtime_error("scheduleEventData: incoming argv[" + std::to_string(i) + "] is null");
         }
+    }
+}
+
+const std::uint64_t *Event::packArgs(void **incoming) const {
+    static thread_local std::vector<std::uint64_t> tuple;
+    tuple.assign(wordCount, 0);
+
+    for (int i = 0; i < argCount; ++i) {
+        std::uint64_t *slot = &tuple[argOffsets[i]];
 
-        // Resize to fit the value
-        size_t sz = typeSize(argTypes[i]);
-        if (sz > ownedArgs[i].bytes.size()) {
-            throw std::runtime_error("ArgSlot too small for arg " + std::to_string(i));
+        if (argTypes[i] != STRING_CODE) {
+            std::memcpy(slot, incoming[i], typeSize(argTypes[i]));
+            continue;
         }
 
-        // Data deserialization
-        std::memcpy(ownedArgs[i].bytes.data(), incoming[i], sz);
-        argv[i] = ownedArgs[i].bytes.data();
+        // Short strings travel inside the slot with a null data pointer, the long ones keep their bytes
+        TString value;
+        std::memcpy(&value, incoming[i], sizeof(TString));
+        if (value.data && value.length <= INLINE_LENGTH) {
+            std::memcpy(slot + 2, value.data, static_cast<std::size_t>(value.length) + 1);
+            value.data = nullptr;
+        } else if (value.data) {
+            // A long string of the caller may be released before the activation, the tuple owns a copy
+            std::size_t bytes = static_cast<std::size_t>(value.length) + 1;
+            char *copy = static_cast<char *>(std::malloc(bytes));
+            std::memcpy(copy, value.data, bytes);
+            value.data = copy;
+        }
+        std::memcpy(slot, &value, sizeof(TString));
     }
+
+    return tuple.data();
 }
 
-void Event::execute() {
-    ffi_cif cif;
-    std::vector<ffi_type *> ffiTypes;
-    ffiTypes.reserve(argCount);
+void Event::freeStrings(const std::uint64_t *tuple) const {
+    for (int i = 0; i < argCount; ++i) {
+        if (argTypes[i] != STRING_CODE)
+            continue;
 
-    // libffi preparation
+        // Short strings are inside their slot, unpacked ones point to it
+        const std::uint64_t *slot = &tuple[argOffsets[i]];
+        TString value;
+        std::memcpy(&value, slot, sizeof(TString));
+        if (value.data && value.data != reinterpret_cast<const char *>(slot + 2))
+            std::free(const_cast<char *>(value.data));
+    }
+}
+
+void Event::unpackStrings() {
     for (int i = 0; i < argCount; ++i) {
-        ffiTypes[i] = codeToFFI(argTypes[i]);
+        if (argTypes[i] != STRING_CODE)
+            continue;
+
+        std::uint64_t *slot = &activeArgs[argOffsets[i]];
+        TString value;
+        std::memcpy(&value, slot, sizeof(TString));
+        if (!value.data) {
+            value.data = reinterpret_cast<const char *>(slot + 2);
+            std::memcpy(slot, &value, sizeof(TString));
+        }
+    }
+}
+
+void Event::enableQueue(std::size_t capacity, QueueFull policy) {
+    queue = std::make_unique<ArgQueue>(capacity, wordCount);
+    queueFull = policy;
+}
+
+void Event::enqueueArgs(void **incoming, bool mayBlock) {
+    checkArgs(incoming);
+    const std::uint64_t *tuple = packArgs(incoming);
+
+    while (true) {
+        // Read before the push, a tuple taken after it is seen by the wait
+        std::uint64_t popped = poppedArgs.load();
+        if (queue->tryPush(tuple))
+            return;
+
+        if (queueFull == QueueFull::DROP_NEWEST) {
+            droppedArgs.fetch_add(1, std::memory_order_relaxed);
+            freeStrings(tuple);
+            return;
+        }
+
+        if (queueFull == QueueFull::DROP_OLDEST) {
+            // Makes room, another producer may take it first so the push is retried
+            static thread_local std::vector<std::uint64_t> oldest;
+            oldest.resize(wordCount);
+            if (queue->tryPop(oldest.data())) {
+                droppedArgs.fetch_add(1, std::memory_order_relaxed);
+                freeStrings(oldest.data());
+            }
+            continue;
+        }
+
+        // Only a running event empties the queue, and it needs the worker or the virtual clock of the caller
+        if (!mayBlock || !getEventRunningFlag()) {
+            droppedArgs.fetch_add(1, std::memory_order_relaxed);
+            freeStrings(tuple);
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(producersMutex);
+        blockedProducers.fetch_add(1);
+        producersCv.wait(lock, [&]() { return poppedArgs.load() != popped || !getEventRunningFlag(); });
+        blockedProducers.fetch_sub(1);
     }
-    if (ffi_prep_cif(&cif, FFI_DEFAULT_ABI, argCount, &ffi_type_void, ffiTypes.data()) != FFI_OK) {
-        std::cerr << "ffi_prep_cif failed for event " << id << "\n";
-        running.store(false);
+}
+
+void Event::wakeProducers() {
+    // Pairs with the counter increment of the producers, one of both sides sees the other
+    if (blockedProducers.load() == 0)
+        return;
+
+    std::lock_guard<std::mutex> lock(producersMutex);
+    producersCv.notify_all();
+}
+
+void Event::setArgsCopy(void **incoming, bool mayBlock) {
+    if (queue) {
+        enqueueArgs(incoming, mayBlock);
         return;
     }
 
+    if (argCount == 0)
+        return;
+
+    // Checking and packing the values before starting the publication
+    checkArgs(incoming);
+    const std::uint64_t *tuple = packArgs(incoming);
+
+    // Writers take turns by moving the sequence to a odd value
+    std::uint32_t seq = argsSeq.load(std::memory_order_relaxed);
+    do {
+        while (seq & 1) {
+            seq = argsSeq.load(std::memory_order_relaxed);
+        }
+    } while (!argsSeq.compare_exchange_weak(seq, seq + 1, std::memory_order_relaxed));
+    std::atomic_thread_fence(std::memory_order_release);
+
+    // Data deserialization, each value is packed in the start of its slot
+    static thread_local std::vector<std::uint64_t> replaced;
+    replaced.resize(wordCount);
+    for (int i = 0; i < wordCount; ++i) {
+        replaced[i] = publishedArgs[i].exchange(tuple[i], std::memory_order_relaxed);
+    }
+
+    // Even sequence, the new snapshot is visible for the readers (0 is kept for never published)
+    std::uint32_t next = seq + 2;
+    argsSeq.store(next == 0 ? 2 : next, std::memory_order_release);
+
+    // The later activations read the new tuple, the replaced strings wait for the ones copying them
+    if (hasStrings) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (argReaders.load(std::memory_order_relaxed) == 0) {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            freeStrings(replaced.data());
+        } else {
+            RetiredArgs *retired = new RetiredArgs{nullptr, replaced};
+            retireArgs(retired, retired);
+        }
+        reclaimStrings();
+    }
+}
+
+void Event::retireArgs(RetiredArgs *first, RetiredArgs *last) {
+    last->next = retiredArgs.load();
+    while (!retiredArgs.compare_exchange_weak(last->next, first)) {
+    }
+}
+
+void Event::reclaimStrings() {
+    // Taken before the readers are checked, a reader that starts later only sees the newer tuples
+    RetiredArgs *list = retiredArgs.exchange(nullptr);
+    if (!list)
+        return;
+
+    // Still copied, the list goes back for the last reader or the next publication
+    if (argReaders.load() != 0) {
+        RetiredArgs *last = list;
+        while (last->next) {
+            last = last->next;
+        }
+        retireArgs(list, last);
+        return;
+    }
+
+    while (list) {
+        freeStrings(list->tuple.data());
+        delete std::exchange(list, list->next);
+    }
+}
+
+bool Event::loadArgs() {
+    // Counted before reading the sequence, so a writer that replaces the strings retires them instead of freeing
+    argReaders.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    bool published = false;
+    while (true) {
+        std::uint32_t before = argsSeq.load(std::memory_order_acquire);
+        if (before == 0)
+            break; // Never published
+        if (before & 1)
+            continue; // Publication in progress
+
+        for (int i = 0; i < wordCount; ++i) {
+            activeArgs[i] = publishedArgs[i].load(std::memory_order_relaxed);
+        }
+
+        // The copy is consistent if no writer started in the meantime
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (argsSeq.load(std::memory_order_relaxed) == before) {
+            published = true;
+            break;
+        }
+    }
+
+    // The activation reads its own copy of the long strings, the buffer only grows to the longest arguments
+    if (published && hasStrings) {
+        std::size_t bytes = 0;
+        for (int i = 0; i < argCount; ++i) {
+            TString value;
+            std::memcpy(&value, &activeArgs[argOffsets[i]], sizeof(TString));
+            if (argTypes[i] == STRING_CODE && value.data)
+                bytes += static_cast<std::size_t>(value.length) + 1;
+        }
+        if (argStrings.size() < bytes)
+            argStrings.resize(bytes);
+
+        char *next = argStrings.data();
+        for (int i = 0; i < argCount; ++i) {
+            TString value;
+            std::memcpy(&value, &activeArgs[argOffsets[i]], sizeof(TString));
+            if (argTypes[i] != STRING_CODE || !value.data)
+                continue;
+
+            std::size_t length = static_cast<std::size_t>(value.length) + 1;
+            std::memcpy(next, value.data, length);
+            value.data = next;
+            std::memcpy(&activeArgs[argOffsets[i]], &value, sizeof(TString));
+            next += length;
+        }
+    }
+
+    // The last reader frees the strings replaced during the copies
+    if (argReaders.fetch_sub(1) == 1 && retiredArgs.load() != nullptr)
+        reclaimStrings();
+    return published;
+}
+
+Event::Clock::time_point Event::nextDeadline(Clock::time_point now) {
+    // Single activation events armed again are due as in a new schedule, an `at` time already passed runs now
+    if (!repeat) {
+        if (kind == EventKind::AFTER)
+            start = now + period;
+        activation = 0;
+        deadline = std::max(start, now);
+        return deadline;
+    }
+
+    // Events without period are due again immediately
+    if (period.count() <= 0) {
+        deadline = now;
+        return deadline;
+    }
+
+    ++activation;
+    deadline = start + period * static_cast<std::int64_t>(activation);
+
+    if (deadline >= now)
+        return deadline;
+
+    // The body overran the period, all the slots until now have missed their deadline
+    std::uint64_t behind = static_cast<std::uint64_t>((now - deadline) / period) + 1;
+
+    switch (overrun) {
+    case Overrun::CATCH_UP:
+        // Only this slot is counted, the next ones are counted when they are reached
+        behind = 1;
+        break;
+    case Overrun::COALESCE:
+        // The missed slots are merged in a single activation that runs now
+        activation += behind - 1;
+        deadline = now;
+        break;
+    default:
+        // Missed activations are skipped keeping the phase of the period
+        activation += behind;
+        deadline = start + period * static_cast<std::int64_t>(activation);
+        break;
+    }
+
+    missedDeadlines.store(missedDeadlines.load(std::memory_order_relaxed) + behind, std::memory_order_relaxed);
+    return deadline;
+}
+
+void Event::recordLateness(Clock::time_point now) {
+    lastLateness = std::max(std::chrono::nanoseconds(0), std::chrono::nanoseconds(now - deadline));
+    maxLateness = std::max(maxLateness, lastLateness);
+    totalLateness += lastLateness;
+    ++lateCount;
+
+    if (stats)
+        stats->lateness.record(lastLateness);
+}
+
+void Event::execute() {
+    // A suspended activation continues with its own arguments, the queue is not read again
+    bool resuming = coroutine != nullptr;
+    if (!resuming && queue) {
+        if (!queue->tryPop(activeArgs.data()))
+            return;
+        poppedArgs.fetch_add(1);
+        wakeProducers();
+    }
+
+    // Body timing, only measured when the statistics or the trace are enabled
+    bool traced = Trace::isEnabled();
+    Clock::time_point wallStart;
+    std::chrono::nanoseconds cpuStart{0};
+    if (stats || traced)
+        wallStart = Clock::now();
+    if (stats)
+        cpuStart = threadCpuTime();
+    if (!resuming) {
+        activationStart = wallStart;
+        activationCpu = std::chrono::nanoseconds(0);
+    }
+
+    // The strings created by the body are released when the activation ends
+    StringArena &threadStrings = StringArena::local();
+    StringArena::Mark region = threadStrings.mark();
+    if (resuming)
+        StringArena::use(strings.get());
+    Event *previous = std::exchange(currentEvent, this);
+
     // Loading the call arguments
-    while (running.load()) {
-        try {
-            // Copy argv under mutex
-            std::vector<void *> localArgv;
-
-            {
-                std::lock_guard<std::mutex> lock(argsMutex);
-                localArgv = argv;
+    try {
+        if (resuming) {
+            // The frame is cleared first, the slice sets it again if it suspends
+            callFrame(std::exchange(coroutine, nullptr), 0);
+
+        } else if (argCount == 0) {
+            // Calling with no argv
+            thunk(nullptr);
+
+        } else {
+            // Lock-free copy of the last published arguments, queued events already have theirs
+            if (!queue && !loadArgs()) {
+                throw std::runtime_error("Event argv contains nullptr (missing schedule args)");
             }
 
-            // Check for nullptr
-            if (argCount == 0) {
-                if (!localArgv.empty()) {
-                    throw std::runtime_error("Event has argCount=0 but argv is not empty");
-                }
-
-                // Calling with no argv
-                ffi_call(&cif, FFI_FN(fnPtr), nullptr, nullptr);
-
-            } else {
-                // Call with argv
-                if ((int)localArgv.size() != argCount) {
-                    throw std::runtime_error("Event argv size mismatch (expected " + std::to_string(argCount) +
-                                             ", got " + std::to_string(localArgv.size()) + ")");
-                }
-
-                for (int i = 0; i < argCount; ++i) {
-                    if (!localArgv[i]) {
-                        throw std::runtime_error("Event argv contains nullptr (missing schedule args)");
-                    }
-                }
-
-                ffi_call(&cif, FFI_FN(fnPtr), nullptr, localArgv.data());
+            // The thunk loads each typed argument from its slot and calls the event directly
+            unpackStrings();
+            thunk(argv.data());
+        }
+
+    } catch (const std::exception &e) {
+        std::cerr << "Exception in event '" << id << "': " << e.what() << "\n";
+    } catch (...) {
+        std::cerr << "Unknown exception in event '" << id << "'\n";
+    }
+    currentEvent = previous;
+    StringArena::use(nullptr);
+    threadStrings.release(region);
+
+    if (stats || traced) {
+        Clock::time_point wallEnd = Clock::now();
+
+        // Each slice is traced, the statistics cover the whole activation
+        if (stats)
+            activationCpu += threadCpuTime() - cpuStart;
+        if (stats && !coroutine) {
+            stats->cpuTime.record(activationCpu);
+            stats->wallTime.record(wallEnd - activationStart);
+        }
+        if (traced)
+            Trace::record(id, wallStart, wallEnd, lastLateness);
+    }
+
+    // The activation is not finished until its last slice
+    if (coroutine)
+        return;
+    if (strings)
+        strings->release(0);
+    if (queue && hasStrings)
+        freeStrings(activeArgs.data());
+
+    // Event execution limit management
+    if (execLimit > 0 && ++execCounter > execLimit - 1)
+        stopEvent();
+}
+
+void Event::suspendCurrent(void *frame, std::chrono::microseconds delay) {
+    if (!currentEvent)
+        return;
+
+    currentEvent->coroutine = frame;
+    currentEvent->resumeDelay = std::max(std::chrono::microseconds(0), delay);
+}
+
+void Event::useOwnStrings() {
+    if (!currentEvent)
+        return;
+
+    if (!currentEvent->strings)
+        currentEvent->strings = std::make_unique<StringArena>(EVENT_CHUNK_SIZE);
+    StringArena::use(currentEvent->strings.get());
+}
+
+void Event::destroyCoroutine() {
+    if (!coroutine)
+        return;
+
+    // The destroy function runs the cleanup of the body, which frees the frame
+    callFrame(std::exchange(coroutine, nullptr), 1);
+    if (strings)
+        strings->release(0);
+    if (queue && hasStrings)
+        freeStrings(activeArgs.data());
+}
+
+bool Event::startEvent(std::uint32_t &generation) {
+    std::uint32_t word = state.load();
+
+    while (true) {
+        EventState s = stateOf(word);
+
+        if (s == EventState::IDLE) {
+            // A new timer chain, the entries left by a previous one are stale
+            std::uint32_t armed = withState(word + GENERATION_STEP, EventState::ARMED);
+            if (state.compare_exchange_weak(word, armed)) {
+                generation = armed / GENERATION_STEP;
+                return true;
             }
+        } else if (s == EventState::STOPPING) {
+            // The activation in progress will arm the event again, single activation events as a pending one
+            EventState next = repeat ? EventState::EXECUTING : EventState::PENDING;
+            if (state.compare_exchange_weak(word, withState(word, next)))
+                return false;
+        } else if (s == EventState::EXECUTING && !repeat) {
+            // Single activation events run once more after the current activation
+            if (state.compare_exchange_weak(word, withState(word, EventState::PENDING)))
+                return false;
+        } else {
+            return false; // Already running
+        }
+    }
+}
+
+bool Event::stopEvent() {
+    std::uint32_t word = state.load();
 
-        } catch (const std::exception &e) {
-            std::cerr << "Exception in event '" << id << "': " << e.what() << "\n";
-        } catch (...) {
-            std::cerr << "Unknown exception in event '" << id << "'\n";
+    while (true) {
+        EventState s = stateOf(word);
+
+        if (s == EventState::ARMED) {
+            // Its timer entry stays in the queue, the new generation makes the scheduler drop it
+            if (state.compare_exchange_weak(word, withState(word + GENERATION_STEP, EventState::IDLE))) {
+                if (queue)
+                    wakeProducers();
+                return true;
+            }
+        } else if (s == EventState::EXECUTING || s == EventState::PENDING) {
+            // The activation in progress will leave the event idle
+            if (state.compare_exchange_weak(word, withState(word, EventState::STOPPING)))
+                return false;
+        } else {
+            return false; // Already stopped
         }
+    }
+}
 
-        // Event execution limit management
-        if (execLimit > 0 && ++execCounter > execLimit - 1)
-            stopEvent();
+bool Event::beginActivation(std::uint32_t generation) {
+    std::uint32_t expected = generation * GENERATION_STEP | static_cast<std::uint32_t>(EventState::ARMED);
+    return state.compare_exchange_strong(expected, withState(expected, EventState::EXECUTING));
+}
 
-        std::this_thread::sleep_for(ticks);
+bool Event::endActivation(std::uint32_t &generation) {
+    std::uint32_t word = state.load();
+
+    while (true) {
+        EventState s = stateOf(word);
+        generation = word / GENERATION_STEP;
+
+        if (s == EventState::EXECUTING) {
+            // Periodic events are armed again, single activation events go back to idle
+            if (state.compare_exchange_weak(word, withState(word, repeat ? EventState::ARMED : EventState::IDLE)))
+                return repeat;
+        } else if (s == EventState::PENDING) {
+            // Activation requested while the body was running
+            if (state.compare_exchange_weak(word, withState(word, EventState::ARMED)))
+                return true;
+        } else {
+            // Stop requested during the activation, the blocked producers drop their tuples
+            if (state.compare_exchange_weak(word, withState(word, EventState::IDLE))) {
+                if (queue)
+                    wakeProducers();
+                return false;
+            }
+        }
     }
 }
@@ -2,98 +2,490 @@
  * @file Event.h
  * @brief Contains the definition of the runtime event structure.
  *
+ * A event whose body uses `wait` or `yield` is compiled as a stackless coroutine: its
+ * activation returns to the worker at each suspension point leaving only a small frame
+ * in the heap, and the scheduler resumes it from the timer queue in any worker. Idle
+ * events hold no thread, so their number is only limited by the memory of the frames.
+ *
  * @author Adrián Zamora Sánchez
  */
 
+#include "ArgQueue.h"
+#include "Histogram.h"
+#include "StringArena.h"
+#include "TString.h"
 #include "math.h"
 #include "spdlog/spdlog.h"
+#include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <cstring>
-#include <ffi.h>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <string>
-#include <thread>
 #include <vector>
 #pragma once
 
+/// Lifecycle of a event inside the scheduler.
+enum class EventState : std::uint8_t {
+    IDLE,      ///< Not scheduled
+    ARMED,     ///< Waiting in the timer queue
+    EXECUTING, ///< Body running in a worker
+    PENDING,   ///< Body running, another activation requested (single activation events)
+    STOPPING   ///< Body running, stop requested
+};
+
+/// Behaviour of a periodic event when its body runs longer than the period, same values as the compiler.
+enum class Overrun : std::uint8_t {
+    SKIP,     ///< Missed activations are dropped, the next one keeps the phase
+    CATCH_UP, ///< Missed activations run back to back until the event is on time
+    COALESCE  ///< Missed activations are merged in one that runs immediately
+};
+
+/// Behaviour of a queued event when its argument queue is full, same values as the compiler.
+enum class QueueFull : std::uint8_t {
+    BLOCK,       ///< The caller waits until a activation takes a tuple, the tuple is dropped if it can not wait
+    DROP_OLDEST, ///< The oldest queued tuple is discarded
+    DROP_NEWEST  ///< The new tuple is discarded
+};
+
+/// Optional timing statistics of a event, enabled with the `T_STATS` environment variable.
+struct EventStats {
+    Histogram lateness; ///< Start of the body - deadline
+    Histogram wallTime; ///< Elapsed time of the body
+    Histogram cpuTime;  ///< CPU time of the body in its worker thread
+};
+
+/// Activation mechanism of a event, same values as the TimeCommand of the compiler.
+enum class EventKind : std::uint8_t {
+    EVERY, ///< Periodic activations
+    AT,    ///< Single activation at a absolute time since the program start
+    AFTER, ///< Single activation a delay after the schedule call
+    WHEN   ///< Single activation each time its condition becomes true
+};
+
 /// This class represents a Event.
 class Event {
-    using EventFn = void (*)();
+  public:
+    using EventThunk = void (*)(void **argv);
+    using Clock = std::chrono::steady_clock;
+
+  private:
+    /// Low bits of the state word that hold the EventState, the arm generation is stored above them.
+    static constexpr std::uint32_t STATE_MASK = 0xff;
+    /// Increment of the state word that starts a new arm generation.
+    static constexpr std::uint32_t GENERATION_STEP = STATE_MASK + 1;
 
-    std::string id;                  ///< Event ID
-    std::chrono::milliseconds ticks; ///< Miliseconds for periodic execution
-    int execLimit;                   ///< Execution limit
-    int execCounter = 0;             ///< Execution counter
+    // hot fields, read or written on every activation
+    std::atomic<std::uint32_t> state{0};             ///< Scheduling state and arm generation, changed together
+    std::chrono::microseconds period;                ///< Time between activations, microsecond resolution
+    int execLimit;                                   ///< Execution limit
+    int execCounter = 0;                             ///< Execution counter
+    EventThunk thunk = nullptr;                      ///< Compiled trampoline, unpacks argv and calls the event function
+    EventKind kind;                                  ///< Activation mechanism
+    bool repeat;                                     ///< Armed again after each activation
+    Overrun overrun = Overrun::SKIP;                 ///< Policy for the activations missed by a overrun
+    int priority = 0;                                ///< Dispatch priority, higher values run first
+    std::chrono::microseconds slack{0};              ///< Delay allowed after each due time to share a timer wake up
+    bool aligned = false;                            ///< Keeps the phase of the schedule call when phases are staggered
+    std::atomic<bool> condition{false};              ///< Last value of the condition of a `when` event
 
-    EventFn fnPtr = nullptr; ///< Compilated function pointer
+    // absolute deadlines, the k-th activation is due at start + k * period
+    Clock::time_point start;      ///< Time of the first activation
+    std::uint64_t activation = 0; ///< Index of the next activation
+    Clock::time_point deadline;   ///< Due time of the next activation
 
-    // arg management
-    int argCount = 0;          ///< Number of total arguments
-    std::vector<int> argTypes; ///< Type codes from Event.cpp
-    std::vector<void *> argv;  ///< Set at schedule call by mainLLVM())
+    // lateness of the activations (start of the body - deadline)
+    std::chrono::nanoseconds lastLateness{0};      ///< Lateness of the last activation
+    std::chrono::nanoseconds maxLateness{0};       ///< Worst lateness observed
+    std::chrono::nanoseconds totalLateness{0};     ///< Sum of all the lateness values
+    std::uint64_t lateCount = 0;                   ///< Number of measured activations
+    std::atomic<std::uint64_t> missedDeadlines{0}; ///< Activation slots that were due before they could start
+    std::unique_ptr<EventStats> stats;             ///< Histograms, only allocated when the statistics are enabled
 
-    struct ArgSlot {
-        alignas(16) std::array<std::uint8_t, 16> bytes{};
+    // cold fields
+    const char *id; ///< Event ID, a constant of the compiled program that is never copied
+
+    // arg management, the arguments are published with a seqlock so scheduling never blocks a activation
+    int argCount = 0;                                            ///< Number of total arguments
+    const int *argTypes;                                         ///< Type codes from Event.cpp, not copied either
+    std::vector<int> argOffsets;                                 ///< First word of each argument in a tuple
+    int wordCount = 0;                                           ///< Words of a argument tuple
+    std::unique_ptr<std::atomic<std::uint64_t>[]> publishedArgs; ///< Last published arguments
+    std::atomic<std::uint32_t> argsSeq{0}; ///< Publication sequence, odd while a writer is copying, 0 if never set
+    std::vector<std::uint64_t> activeArgs; ///< Snapshot used by the activation in progress
+    std::vector<void *> argv;              ///< Pointers to the snapshot slots, passed to the thunk
+    bool hasStrings = false;               ///< Some parameter is a string, its long values are owned copies
+    std::atomic<int> argReaders{0};        ///< Activations copying the published arguments
+    std::vector<char> argStrings;          ///< Long strings of the snapshot, reused by every activation
+
+    /// Tuple replaced while a activation was copying it, its strings are freed once no activation reads them.
+    struct RetiredArgs {
+        RetiredArgs *next;                ///< Previously retired tuple
+        std::vector<std::uint64_t> tuple; ///< Replaced words
     };
-    std::vector<ArgSlot> ownedArgs;
+    std::atomic<RetiredArgs *> retiredArgs{nullptr}; ///< Tuples waiting to be freed, the newest first
+
+    // queued mode, each schedule call adds a tuple and each activation consumes one
+    std::unique_ptr<ArgQueue> queue;           ///< Queued argument tuples, only allocated in queued mode
+    QueueFull queueFull = QueueFull::BLOCK;    ///< Policy when the queue is full
+    std::atomic<std::uint64_t> droppedArgs{0}; ///< Tuples discarded by the full-queue policy
+    std::atomic<std::uint64_t> poppedArgs{0};  ///< Tuples taken by the activations, waited for by blocked producers
+    std::atomic<int> blockedProducers{0};      ///< Producers waiting for room in the queue
+    std::mutex producersMutex;                 ///< Serializes the wait of the producers with their wake ups
+    std::condition_variable producersCv;       ///< Signalled when a tuple is taken or the event stops
+
+    // coroutine bodies, a activation may be split in several slices by `wait` and `yield`
+    void *coroutine = nullptr;                 ///< Frame of the suspended activation, nullptr if it is not suspended
+    std::chrono::microseconds resumeDelay{0};  ///< Time from the suspension until the next slice
+    std::unique_ptr<StringArena> strings;      ///< Strings of the body, they must survive the suspensions
+    Clock::time_point activationStart;         ///< Start of the first slice of the activation
+    std::chrono::nanoseconds activationCpu{0}; ///< CPU time of the previous slices of the activation
+
+    /**
+     * @brief Scheduling state of a state word.
+     * @param word Value of `state`.
+     * @return State stored in the low bits.
+     */
+    static EventState stateOf(std::uint32_t word) { return static_cast<EventState>(word & STATE_MASK); }
+
+    /**
+     * @brief Replaces the scheduling state of a state word, keeping its generation.
+     * @param word Value of `state`.
+     * @param s New state.
+     * @return New value of `state`.
+     */
+    static std::uint32_t withState(std::uint32_t word, EventState s) {
+        return (word & ~STATE_MASK) | static_cast<std::uint32_t>(s);
+    }
+
+    /**
+     * @brief Checks that the incoming arguments can be copied.
+     * @param incoming Pointers to the argument values.
+     */
+    void checkArgs(void **incoming) const;
+
+    /**
+     * @brief Packs the incoming arguments in a tuple, the short strings are copied inside their slot.
+     *
+     * The long strings are copied to the heap, the tuple owns them until freeStrings().
+     *
+     * @param incoming Pointers to the argument values.
+     * @return Tuple of `wordCount` words, valid until the next call in the same thread.
+     */
+    const std::uint64_t *packArgs(void **incoming) const;
+
+    /**
+     * @brief Frees the long strings owned by a tuple.
+     * @param tuple Tuple of `wordCount` words, packed or unpacked.
+     */
+    void freeStrings(const std::uint64_t *tuple) const;
+
+    /// Points the inline strings of the activation snapshot to their own slot.
+    void unpackStrings();
+
+    /**
+     * @brief Adds retired tuples to the list freed by reclaimStrings().
+     * @param first Newest tuple of the chain.
+     * @param last Oldest tuple of the chain.
+     */
+    void retireArgs(RetiredArgs *first, RetiredArgs *last);
+
+    /// Frees the strings of the retired tuples if no activation is copying the published arguments.
+    void reclaimStrings();
 
-    std::mutex argsMutex;
+    /**
+     * @brief Adds a argument tuple to the queue, applying the full-queue policy.
+     * @param incoming Pointers to the argument values.
+     * @param mayBlock `false` if the caller can not wait for a activation, a blocking policy drops the tuple.
+     */
+    void enqueueArgs(void **incoming, bool mayBlock);
 
-    std::atomic<bool> running{false};
-    std::thread worker;
+    /// Wakes the producers blocked in a full queue, after a tuple is taken or the event stops.
+    void wakeProducers();
+
+    /**
+     * @brief Copies the last published arguments into the activation snapshot.
+     *
+     * The long strings are copied to `argStrings`, so a later publication can free the published ones.
+     * The last activation that leaves frees the strings retired while it was copying.
+     *
+     * @return `false` if the arguments were never published.
+     */
+    bool loadArgs();
 
   public:
     /**
      * @brief Default Event constructor.
-     * @param id Identifier for this Event.
-     * @param f Its executable code (a extern function).
-     * @param t Ticks associated with the periodic execution.
+     * @param id Identifier for this Event, must outlive it.
+     * @param period Time between activations, or until the activation for `at` and `after` events.
+     * @param thunk Its executable code (the `<event>_thunk` trampoline generated by the compiler).
+     * @param argCount Number of parameters of the event.
+     * @param argTypes Type codes of the parameters, must outlive the Event.
      * @param execLimit Limit of executions.
+     * @param kind Activation mechanism, periodic by default.
      */
-    Event(std::string id, float t, EventFn fnPtr, int argCount, const int *argTypes, int limit);
+    Event(const char *id,
+          std::chrono::microseconds period,
+          EventThunk thunk,
+          int argCount,
+          const int *argTypes,
+          int limit,
+          EventKind kind = EventKind::EVERY);
 
-    /// Default Event destructor, important in thread termination management
+    /// Event destructor, frees the strings of the published and queued arguments.
     ~Event();
 
-    /// Executes the event code.
+    /// Executes the event code once (a single activation), or the next slice of a suspended one.
     void execute();
 
-    /// Copy of argument data for events
-    void setArgsCopy(void **incoming);
+    /**
+     * @brief Suspends the activation running in the calling thread, called before the frame returns.
+     * @param frame Coroutine frame of the activation.
+     * @param delay Time until the activation is resumed, 0 for `yield`.
+     */
+    static void suspendCurrent(void *frame, std::chrono::microseconds delay);
+
+    /// Moves the strings of the activation running in the calling thread to its own arena.
+    static void useOwnStrings();
+
+    /**
+     * @brief Suspension check.
+     * @return `true` if the last slice ended in a `wait` or `yield`.
+     */
+    bool isSuspended() const { return coroutine != nullptr; }
+
+    /**
+     * @brief Getter for the resume delay.
+     * @return Time from the last suspension until the next slice.
+     */
+    std::chrono::microseconds getResumeDelay() const { return resumeDelay; }
+
+    /// Ends a suspended activation without running the rest of its body, freeing its frame.
+    void destroyCoroutine();
+
+    /**
+     * @brief Publishes a copy of the arguments for the next activations, without locks or allocation.
+     *
+     * In queued mode the copy is added to the argument queue instead, for a single activation.
+     *
+     * @param incoming Pointers to the argument values.
+     * @param mayBlock `false` if the caller can not wait for a activation to take a queued tuple.
+     */
+    void setArgsCopy(void **incoming, bool mayBlock = true);
+
+    /**
+     * @brief Switches to queued mode, must be called before the first activation.
+     * @param capacity Maximum number of pending argument tuples.
+     * @param policy Behaviour when a tuple is added to a full queue.
+     */
+    void enableQueue(std::size_t capacity, QueueFull policy);
+
+    /**
+     * @brief Getter for the dropped tuples.
+     * @return Argument tuples discarded because the queue was full.
+     */
+    std::uint64_t getDroppedArgs() const { return droppedArgs.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Queued mode check.
+     * @return `true` if each activation consumes a queued argument tuple.
+     */
+    bool isQueued() const { return queue != nullptr; }
+
+    /**
+     * @brief Stores the new value of the activation condition.
+     * @param value Result of evaluating the condition.
+     * @return `true` if the condition changed from false to true.
+     */
+    bool updateCondition(bool value) { return !condition.exchange(value) && value; }
+
+    /**
+     * @brief Getter for the period.
+     * @return Time between two activations of this Event.
+     */
+    std::chrono::microseconds getPeriod() const { return period; }
+
+    /**
+     * @brief Sets the time of the first activation, the following ones are multiples of the period.
+     * @param now Time of the schedule call.
+     * @param epoch Start time of the program, origin of the `at` events.
+     * @param phase Delay of the first periodic activation, assigned by the scheduler when it staggers the phases.
+     */
+    void resetDeadline(Clock::time_point now,
+                       Clock::time_point epoch,
+                       Clock::duration phase = Clock::duration::zero()) {
+        if (kind == EventKind::AFTER) {
+            start = now + period;
+        } else if (kind == EventKind::AT) {
+            start = epoch + period;
+        } else {
+            start = now + phase;
+        }
+
+        activation = 0;
+        deadline = start;
+    }
+
+    /**
+     * @brief Getter for the activation mechanism.
+     * @return Kind of this Event.
+     */
+    EventKind getKind() const { return kind; }
+
+    /**
+     * @brief Getter for the deadline.
+     * @return Due time of the next activation.
+     */
+    Clock::time_point getDeadline() const { return deadline; }
+
+    /**
+     * @brief Advances the deadline to the next activation that is not in the past.
+     *
+     * Single activation events armed again get the deadline of a new schedule instead of the next period.
+     *
+     * @param now Current time.
+     * @return Due time of the next activation.
+     */
+    Clock::time_point nextDeadline(Clock::time_point now);
+
+    /**
+     * @brief Measures how late the current activation started.
+     * @param now Start time of the activation.
+     */
+    void recordLateness(Clock::time_point now);
+
+    /**
+     * @brief Getter for the worst lateness.
+     * @return Maximum lateness observed in the activations of this Event.
+     */
+    std::chrono::nanoseconds getMaxLateness() const { return maxLateness; }
 
     /**
-     * @brief Getter for the worker thread.
-     * @return Worker thread of this Event.
+     * @brief Getter for the mean lateness.
+     * @return Mean lateness of the activations of this Event.
      */
-    std::thread &getWorker() { return worker; }
+    std::chrono::nanoseconds getMeanLateness() const {
+        return lateCount ? totalLateness / static_cast<std::int64_t>(lateCount) : std::chrono::nanoseconds(0);
+    }
 
     /**
      * @brief Getter for id.
      * @return Returns the identifier of the Event.
      */
-    std::string &getID() { return id; }
+    const char *getID() const { return id; }
+
+    /**
+     * @brief Requests the termination of the event.
+     *
+     * A event waiting in the timer queue starts a new arm generation, so its timer entry becomes stale.
+     *
+     * @return `true` if the Event was waiting in the timer queue and is now idle, `false` otherwise.
+     */
+    bool stopEvent();
+
+    /**
+     * @brief Requests the execution of the event.
+     * @param generation Set to the arm generation of the new timer chain when the Event must be armed.
+     * @return `true` if the Event was idle and must be armed in the scheduler, `false` otherwise.
+     */
+    bool startEvent(std::uint32_t &generation);
 
-    /// Sets the running flag to false for safe thread termination.
-    void stopEvent() { running.store(false); };
+    /**
+     * @brief Marks the start of a activation.
+     * @param generation Arm generation of the timer entry that is due.
+     * @return `false` if the Event was stopped while waiting in the timer queue or the entry is stale.
+     */
+    bool beginActivation(std::uint32_t generation);
 
-    /// Sets the running flag to true for event execution.
-    void startEvent() {
-        if (running.load())
-            return;
+    /**
+     * @brief Marks the end of a activation.
+     * @param generation Set to the arm generation of the next timer entry when the Event must be armed again.
+     * @return `true` if the Event must be armed again, `false` if it is now idle.
+     */
+    bool endActivation(std::uint32_t &generation);
 
-        running.store(true);
-        getWorker() = std::thread([this]() { execute(); });
-    };
+    /**
+     * @brief Getter for the arm generation.
+     * @return Generation of the current timer chain, the timer entries of other generations are stale.
+     */
+    std::uint32_t getArmGeneration() const { return state.load() / GENERATION_STEP; }
+
+    /**
+     * @brief Stop check.
+     * @return `true` if the termination was requested while the Event was running.
+     */
+    bool isStopping() const { return stateOf(state.load()) == EventState::STOPPING; }
 
     /**
      * @brief Getter for running flag.
      * @return `true` if the Event is running, `false` otherwise.
      */
-    bool getEventRunningFlag() { return running.load(); };
+    bool getEventRunningFlag() const {
+        EventState s = stateOf(state.load());
+        return s == EventState::ARMED || s == EventState::EXECUTING || s == EventState::PENDING;
+    };
+
+    /**
+     * @brief Sets the overrun policy, must be called before the first activation.
+     * @param policy Behaviour when the body runs longer than the period.
+     */
+    void setOverrun(Overrun policy) { overrun = policy; }
+
+    /**
+     * @brief Sets the dispatch priority, must be called before the first activation.
+     * @param value Priority, higher values run first when the workers are busy.
+     */
+    void setPriority(int value) { priority = value; }
+
+    /**
+     * @brief Getter for the priority.
+     * @return Dispatch priority of the Event.
+     */
+    int getPriority() const { return priority; }
+
+    /**
+     * @brief Sets the slack, must be called before the first activation.
+     * @param value Time each activation may be delayed so it runs in the same timer wake up as others.
+     */
+    void setSlack(std::chrono::microseconds value) { slack = std::max(std::chrono::microseconds(0), value); }
+
+    /**
+     * @brief Getter for the slack.
+     * @return Delay allowed after each due time.
+     */
+    std::chrono::microseconds getSlack() const { return slack; }
+
+    /// Keeps the first activation at the schedule call when the scheduler staggers the phases.
+    void setAligned() { aligned = true; }
+
+    /**
+     * @brief Phase alignment check.
+     * @return `true` if the Event is never staggered.
+     */
+    bool isAligned() const { return aligned; }
+
+    /**
+     * @brief Getter for the missed deadlines.
+     * @return Number of activation slots that were due before the previous activation finished.
+     */
+    std::uint64_t getMissedDeadlines() const { return missedDeadlines.load(std::memory_order_relaxed); }
+
+    /// Allocates the histograms of this Event, must be called before its first activation.
+    void enableStats() { stats = std::make_unique<EventStats>(); }
+
+    /**
+     * @brief Getter for the statistics.
+     * @return Histograms of this Event, nullptr if the statistics are disabled.
+     */
+    const EventStats *getStats() const { return stats.get(); }
 
     /// Prints the event data.
-    void print() const { spdlog::debug("Event: {}", id); };
+    void print() const {
+        spdlog::debug("Event: {} (activations: {}, missed deadlines: {}, mean lateness: {} ns, max lateness: {} ns)", id,
+                      lateCount, getMissedDeadlines(), getMeanLateness().count(), maxLateness.count());
+    };
 };
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include "EventRegistry.h"
+
+namespace {
+
+EventHandle makeHandle(std::uint32_t index, std::uint32_t generation) {
+    return (static_cast<EventHandle>(generation) << 32) | index;
+}
+
+std::uint32_t handleIndex(EventHandle handle) {
+    return static_cast<std::uint32_t>(handle);
+}
+
+std::uint32_t handleGeneration(EventHandle handle) {
+    return static_cast<std::uint32_t>(handle >> 32);
+}
+
+} // namespace
+
+EventRegistry::~EventRegistry() {
+    for (auto &page : pages) {
+        delete page.load(std::memory_order_relaxed);
+    }
+}
+
+EventRegistry::Slot *EventRegistry::slotAt(std::uint32_t index) const {
+    std::uint32_t pageIndex = index / PAGE_SIZE;
+    if (pageIndex >= MAX_PAGES)
+        return nullptr;
+
+    Page *page = pages[pageIndex].load(std::memory_order_acquire);
+    if (!page)
+        return nullptr;
+
+    return &(*page)[index % PAGE_SIZE];
+}
+
+EventHandle EventRegistry::add(const char *id,
+                               std::chrono::microseconds period,
+                               Event::EventThunk thunk,
+                               int argCount,
+                               const int *argTypes,
+                               int limit,
+                               EventKind kind) {
+    std::lock_guard<std::mutex> lock(addMutex);
+
+    std::uint32_t index = count.load(std::memory_order_relaxed);
+    std::uint32_t pageIndex = index / PAGE_SIZE;
+    if (pageIndex >= MAX_PAGES) {
+        spdlog::error("Event registry full, event {} discarded", id);
+        return 0;
+    }
+
+    // Pages are allocated on demand and published before the slot becomes valid
+    if (!pages[pageIndex].load(std::memory_order_relaxed))
+        pages[pageIndex].store(new Page(), std::memory_order_release);
+
+    Slot &slot = (*pages[pageIndex].load(std::memory_order_relaxed))[index % PAGE_SIZE];
+    slot.event.emplace(id, period, thunk, argCount, argTypes, limit, kind);
+
+    // Odd generation, the handle becomes valid for the lock-free readers
+    slot.generation.store(1, std::memory_order_release);
+    count.store(index + 1, std::memory_order_release);
+    live.fetch_add(1, std::memory_order_relaxed);
+
+    return makeHandle(index, 1);
+}
+
+Event *EventRegistry::get(EventHandle handle) const {
+    Slot *slot = slotAt(handleIndex(handle));
+    if (!slot || handleGeneration(handle) == 0)
+        return nullptr;
+
+    if (slot->generation.load(std::memory_order_acquire) != handleGeneration(handle))
+        return nullptr;
+
+    return &*slot->event;
+}
+
+Event *EventRegistry::release(EventHandle handle) {
+    Slot *slot = slotAt(handleIndex(handle));
+    if (!slot || handleGeneration(handle) == 0)
+        return nullptr;
+
+    // Only one caller can move the slot to the next generation
+    std::uint32_t expected = handleGeneration(handle);
+    if (!slot->generation.compare_exchange_strong(expected, expected + 1, std::memory_order_acq_rel))
+        return nullptr;
+
+    live.fetch_sub(1, std::memory_order_relaxed);
+    return &*slot->event;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file EventRegistry.h
+ * @brief Contains the definition of the event registry.
+ *
+ * The registry is a slot map: every registered event gets a slot and a integer handle that
+ * encodes the slot index and its generation. Lookups are a array access plus a generation check,
+ * so they take constant time and do not need a lock.
+ *
+ * @author Adrián Zamora Sánchez
+ * @see Event.h
+ * @see Runtime.h
+ */
+
+#pragma once
+#include "Event.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+/// Generation-checked event handle, `(generation << 32) | index`. The value 0 is never a valid handle.
+using EventHandle = std::uint64_t;
+
+/// Slot map that owns all the events of the program.
+class EventRegistry {
+    static constexpr std::uint32_t PAGE_SIZE = 256;  ///< Slots per page
+    static constexpr std::uint32_t MAX_PAGES = 4096; ///< Page table size, up to 1M events
+
+    /// Storage of a event, the generation is odd while the slot holds a live event.
+    struct Slot {
+        std::atomic<std::uint32_t> generation{0}; ///< Generation of the handle currently valid
+        std::optional<Event> event;               ///< Event stored in place
+    };
+
+    using Page = std::array<Slot, PAGE_SIZE>;
+
+    std::array<std::atomic<Page *>, MAX_PAGES> pages{}; ///< Page table, pages never move once allocated
+    std::atomic<std::uint32_t> count{0};                ///< Number of slots in use
+    std::atomic<std::uint32_t> live{0};                 ///< Number of valid handles
+    std::mutex addMutex;                                ///< Serializes the registrations
+
+    /**
+     * @brief Slot lookup.
+     * @param index Slot index.
+     * @return Slot, or nullptr if its page is not allocated.
+     */
+    Slot *slotAt(std::uint32_t index) const;
+
+  public:
+    EventRegistry() = default;
+    EventRegistry(const EventRegistry &) = delete;
+    EventRegistry &operator=(const EventRegistry &) = delete;
+
+    /// Registry destructor, frees the pages.
+    ~EventRegistry();
+
+    /**
+     * @brief Creates a event in a new slot.
+     * @return Handle of the event, or 0 if the registry is full.
+     */
+    EventHandle add(const char *id,
+                    std::chrono::microseconds period,
+                    Event::EventThunk thunk,
+                    int argCount,
+                    const int *argTypes,
+                    int limit,
+                    EventKind kind = EventKind::EVERY);
+
+    /**
+     * @brief Handle lookup.
+     * @param handle Event handle.
+     * @return Event, or nullptr if the handle is not valid.
+     */
+    Event *get(EventHandle handle) const;
+
+    /**
+     * @brief Invalidates a handle, only the first call with a given handle succeeds.
+     * @param handle Event handle.
+     * @return Event released, or nullptr if the handle was not valid.
+     *
+     * Slots are not reused, so the event stays in memory for the workers that still hold it.
+     */
+    Event *release(EventHandle handle);
+
+    /**
+     * @brief Number of registered events.
+     * @return Amount of live events.
+     */
+    std::size_t size() const { return live.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Calls a function for every live event.
+     * @param fn Function to call.
+     */
+    template <typename F> void forEach(F &&fn) const {
+        std::uint32_t used = count.load(std::memory_order_acquire);
+        for (std::uint32_t i = 0; i < used; ++i) {
+            Slot *slot = slotAt(i);
+            if (slot && (slot->generation.load(std::memory_order_acquire) & 1u))
+                fn(*slot->event);
+        }
+    }
+};
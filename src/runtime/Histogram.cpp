@@ -0,0 +1,72 @@
+#include "Histogram.h"
+#include <algorithm>
+#include <cmath>
+
+int Histogram::bucketOf(std::uint64_t value) {
+    // Small values are stored exactly
+    if (value < SUB_COUNT)
+        return static_cast<int>(value);
+
+    // Power of two of the value and its next SUB_BITS bits
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - SUB_BITS;
+    int bucket = (shift + 1) * SUB_COUNT + static_cast<int>((value >> shift) & (SUB_COUNT - 1));
+
+    return std::min(bucket, BUCKETS - 1);
+}
+
+std::uint64_t Histogram::bucketLimit(int bucket) {
+    if (bucket < SUB_COUNT)
+        return static_cast<std::uint64_t>(bucket);
+
+    int shift = bucket / SUB_COUNT - 1;
+    std::uint64_t sub = static_cast<std::uint64_t>(bucket % SUB_COUNT + SUB_COUNT);
+    return ((sub + 1) << shift) - 1;
+}
+
+void Histogram::record(std::chrono::nanoseconds value) {
+    std::uint64_t ns = value.count() > 0 ? static_cast<std::uint64_t>(value.count()) : 0;
+
+    // Single writer, plain load and store are enough for the readers to see whole values
+    std::atomic<std::uint64_t> &bucket = counts[bucketOf(ns)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    total.store(total.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    if (ns > maxValue.load(std::memory_order_relaxed))
+        maxValue.store(ns, std::memory_order_relaxed);
+}
+
+void Histogram::merge(const Histogram &other) {
+    std::uint64_t added = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+        std::uint64_t value = other.counts[i].load(std::memory_order_relaxed);
+        counts[i].store(counts[i].load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        added += value;
+    }
+
+    // The total is the sum of the buckets read, the other total may have moved meanwhile
+    total.store(total.load(std::memory_order_relaxed) + added, std::memory_order_relaxed);
+
+    std::uint64_t otherMax = other.maxValue.load(std::memory_order_relaxed);
+    if (otherMax > maxValue.load(std::memory_order_relaxed))
+        maxValue.store(otherMax, std::memory_order_relaxed);
+}
+
+std::chrono::nanoseconds Histogram::getPercentile(double percentile) const {
+    std::uint64_t count = getCount();
+    if (count == 0)
+        return std::chrono::nanoseconds(0);
+
+    // Rank of the percentile among the recorded values
+    std::uint64_t rank = static_cast<std::uint64_t>(std::ceil(percentile / 100.0 * count));
+    rank = std::clamp<std::uint64_t>(rank, 1, count);
+
+    std::uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+        seen += counts[i].load(std::memory_order_relaxed);
+        if (seen >= rank)
+            return std::chrono::nanoseconds(std::min(bucketLimit(i), maxValue.load(std::memory_order_relaxed)));
+    }
+
+    return getMax();
+}
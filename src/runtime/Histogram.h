@@ -0,0 +1,77 @@
+/**
+ * @file Histogram.h
+ * @brief Contains the definition of the duration histogram used by the event statistics.
+ *
+ * The buckets follow a log-linear (HDR) layout: every power of two is split in
+ * 8 linear sub-buckets, so the relative error of a recorded value is below 12.5%
+ * from nanoseconds to hours with a few hundred counters.
+ *
+ * @author Adrián Zamora Sánchez
+ * @see Event.h
+ */
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/// Log-linear histogram of durations, written by one thread and readable from any other.
+class Histogram {
+    static constexpr int SUB_BITS = 3;                 ///< Bits of precision inside each power of two
+    static constexpr int SUB_COUNT = 1 << SUB_BITS;    ///< Sub-buckets per power of two
+    static constexpr int GROUPS = 46;                  ///< Powers of two covered, up to ~39 hours in ns
+    static constexpr int BUCKETS = GROUPS * SUB_COUNT; ///< Total number of counters
+
+    std::array<std::atomic<std::uint64_t>, BUCKETS> counts{}; ///< Values per bucket
+    std::atomic<std::uint64_t> total{0};                     ///< Number of recorded values
+    std::atomic<std::uint64_t> maxValue{0};                  ///< Largest recorded value in ns
+
+    /**
+     * @brief Bucket of a value.
+     * @param value Duration in ns.
+     * @return Index of its bucket.
+     */
+    static int bucketOf(std::uint64_t value);
+
+    /**
+     * @brief Largest value stored in a bucket.
+     * @param bucket Index of the bucket.
+     * @return Upper bound of the bucket in ns.
+     */
+    static std::uint64_t bucketLimit(int bucket);
+
+  public:
+    /**
+     * @brief Adds a value, only one thread may record at a time.
+     * @param value Duration to record, negative values are recorded as 0.
+     */
+    void record(std::chrono::nanoseconds value);
+
+    /**
+     * @brief Adds the values of another histogram, with the same single writer rule as record().
+     * @param other Histogram to merge, it may still be recorded by its own thread.
+     */
+    void merge(const Histogram &other);
+
+    /**
+     * @brief Getter for the number of values.
+     * @return Amount of recorded values.
+     */
+    std::uint64_t getCount() const { return total.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Getter for the maximum.
+     * @return Largest recorded value.
+     */
+    std::chrono::nanoseconds getMax() const {
+        return std::chrono::nanoseconds(maxValue.load(std::memory_order_relaxed));
+    }
+
+    /**
+     * @brief Value at a given percentile.
+     * @param percentile Percentile between 0 and 100.
+     * @return Upper bound of the bucket that contains the percentile, 0 if there are no values.
+     */
+    std::chrono::nanoseconds getPercentile(double percentile) const;
+};
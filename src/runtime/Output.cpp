@@ -0,0 +1,182 @@
+#include "Output.h"
+#include "spdlog/spdlog.h"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+Output::State &Output::state() {
+    static State instance;
+    return instance;
+}
+
+void Output::configureFromEnv() {
+    // Creates the state before the global runtime finishes its construction, so it is destroyed after it
+    State &s = state();
+
+    // Invalid values keep the defaults
+    if (const char *env = std::getenv("T_PRINT_BUFFER")) {
+        try {
+            s.limit = static_cast<std::size_t>(std::max(0L, std::stol(env)));
+        } catch (const std::exception &) {
+            spdlog::warn("Invalid T_PRINT_BUFFER value: {}", env);
+        }
+    }
+
+    if (const char *env = std::getenv("T_PRINT_FLUSH")) {
+        try {
+            s.interval = std::chrono::milliseconds(std::max(1, std::stoi(env)));
+        } catch (const std::exception &) {
+            spdlog::warn("Invalid T_PRINT_FLUSH value: {}", env);
+        }
+    }
+}
+
+Output::ThreadBuffer &Output::threadBuffer() {
+    thread_local ThreadBuffer *buffer = nullptr;
+
+    if (!buffer) {
+        auto created = std::make_unique<ThreadBuffer>();
+        buffer = created.get();
+
+        std::lock_guard<std::mutex> lock(state().buffersMutex);
+        state().buffers.push_back(std::move(created));
+    }
+
+    return *buffer;
+}
+
+/**
+ * @brief Appends the strings of a line and its end to a buffer, the lengths are known so nothing is scanned.
+ * @param out Destination buffer.
+ * @param count Number of strings.
+ * @param parts Bytes and length of each string.
+ */
+static void appendLine(std::string &out, int count, va_list parts) {
+    for (int i = 0; i < count; ++i) {
+        const char *data = va_arg(parts, const char *);
+        std::int64_t length = va_arg(parts, std::int64_t);
+        out.append(data, static_cast<std::size_t>(length));
+    }
+    out += '\n';
+}
+
+void Output::printLine(int count, va_list parts) {
+    State &s = state();
+
+    // Unbuffered output, one write per line
+    if (s.limit == 0) {
+        thread_local std::string line;
+        line.clear();
+        appendLine(line, count, parts);
+
+        iovec part{line.data(), line.size()};
+        std::lock_guard<std::mutex> lock(s.writeMutex);
+        writeAll(&part, 1);
+        return;
+    }
+
+    std::call_once(s.writerFlag, []() { state().writer = std::thread(writerLoop); });
+
+    // The whole line is appended at once, the writer never sees half of it
+    ThreadBuffer &buffer = threadBuffer();
+    thread_local std::string full;
+    {
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        appendLine(buffer.data, count, parts);
+
+        if (buffer.data.size() < s.limit)
+            return;
+        std::swap(full, buffer.data);
+    }
+
+    // A full buffer is written by its own thread, the older lines taken by the writer are written first
+    iovec part{full.data(), full.size()};
+    {
+        std::lock_guard<std::mutex> lock(s.writeMutex);
+        writeAll(&part, 1);
+    }
+    full.clear();
+}
+
+void Output::writerLoop() {
+    State &s = state();
+    std::unique_lock<std::mutex> lock(s.stopMutex);
+
+    while (!s.stopping) {
+        s.stopCv.wait_for(lock, s.interval);
+        lock.unlock();
+        flush();
+        lock.lock();
+    }
+}
+
+void Output::flush() {
+    State &s = state();
+    std::lock_guard<std::mutex> writeLock(s.writeMutex);
+
+    // The buffers are swapped with the empty strings of the previous flush, keeping both allocations
+    {
+        std::lock_guard<std::mutex> lock(s.buffersMutex);
+        s.pending.resize(s.buffers.size());
+        for (std::size_t i = 0; i < s.buffers.size(); ++i) {
+            std::lock_guard<std::mutex> bufferLock(s.buffers[i]->mutex);
+            std::swap(s.pending[i], s.buffers[i]->data);
+        }
+    }
+
+    std::vector<iovec> parts;
+    parts.reserve(s.pending.size());
+    for (std::string &data : s.pending) {
+        if (!data.empty())
+            parts.push_back({data.data(), data.size()});
+    }
+
+    // A single system call for all the threads, unless there are more of them than IOV_MAX
+    for (std::size_t i = 0; i < parts.size(); i += IOV_MAX) {
+        writeAll(parts.data() + i, static_cast<int>(std::min<std::size_t>(IOV_MAX, parts.size() - i)));
+    }
+
+    for (std::string &data : s.pending) {
+        data.clear();
+    }
+}
+
+void Output::writeAll(iovec *parts, int count) {
+    while (count > 0) {
+        ssize_t written = writev(STDOUT_FILENO, parts, count);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            return; // Closed or failing output, the lines are discarded
+        }
+
+        // Skips the buffers already written and advances the partial one
+        while (count > 0 && static_cast<std::size_t>(written) >= parts->iov_len) {
+            written -= static_cast<ssize_t>(parts->iov_len);
+            ++parts;
+            --count;
+        }
+        if (count > 0) {
+            parts->iov_base = static_cast<char *>(parts->iov_base) + written;
+            parts->iov_len -= static_cast<std::size_t>(written);
+        }
+    }
+}
+
+void Output::stop() {
+    State &s = state();
+
+    {
+        std::lock_guard<std::mutex> lock(s.stopMutex);
+        s.stopping = true;
+    }
+    s.stopCv.notify_all();
+
+    if (s.writer.joinable())
+        s.writer.join();
+
+    flush();
+}
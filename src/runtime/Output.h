@@ -0,0 +1,95 @@
+/**
+ * @file Output.h
+ * @brief Contains the definition of the buffered program output.
+ *
+ * The `print` built-in appends whole lines to a buffer of the calling thread, so the
+ * event threads never share a stdio lock. A background writer collects the buffers of
+ * every thread and writes them with a single `writev` each `T_PRINT_FLUSH` milliseconds,
+ * a thread whose buffer reaches `T_PRINT_BUFFER` bytes writes it by itself, and
+ * everything left is written at exit.
+ *
+ * The lines of a thread keep their order, lines of different threads are never mixed.
+ *
+ * @author Adrián Zamora Sánchez
+ * @see Runtime.h
+ */
+
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <sys/uio.h>
+#include <thread>
+#include <vector>
+
+/// Standard output shared by all the threads of the program.
+class Output {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+  private:
+    /// Lines printed by a single thread and not written yet.
+    struct ThreadBuffer {
+        std::mutex mutex; ///< Only contended when the writer takes the buffer
+        std::string data; ///< Pending lines
+    };
+
+    /// Output data, a function static so it outlives the global runtime that flushes it at exit.
+    struct State {
+        std::size_t limit = 64 * 1024;                      ///< Bytes of a buffer before its thread writes it
+        std::chrono::milliseconds interval{20};             ///< Time between the writer flushes
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers; ///< Buffers of all the threads
+        std::mutex buffersMutex;                            ///< Only taken when a thread prints for the first time
+        std::mutex writeMutex;                              ///< Serializes the writes, keeps each thread in order
+        std::vector<std::string> pending;                   ///< Buffers taken by the last flush, reused by the next
+        std::thread writer;                                 ///< Background writer
+        std::once_flag writerFlag;                          ///< Lazy start of the writer
+        std::mutex stopMutex;                               ///< Stop flag mutex
+        std::condition_variable stopCv;                     ///< Wakes up the writer
+        bool stopping = false;                              ///< Stop flag
+    };
+
+    /**
+     * @brief Getter for the output data.
+     * @return Data shared by all the threads.
+     */
+    static State &state();
+
+    /**
+     * @brief Buffer of the calling thread, created on its first print.
+     * @return Thread buffer.
+     */
+    static ThreadBuffer &threadBuffer();
+
+    /// Writer loop, flushes every buffer once per interval until the output is stopped.
+    static void writerLoop();
+
+    /// Writes the buffers of every thread, in a single `writev` when possible.
+    static void flush();
+
+    /**
+     * @brief Writes a list of buffers to the standard output, retrying the partial writes.
+     * @param parts Buffers to write, modified by the call.
+     * @param count Number of buffers.
+     */
+    static void writeAll(iovec *parts, int count);
+
+  public:
+    /// Reads `T_PRINT_BUFFER` (bytes, 0 writes each line at once) and `T_PRINT_FLUSH` (milliseconds).
+    static void configureFromEnv();
+
+    /**
+     * @brief Appends a line to the buffer of the calling thread.
+     * @param count Number of strings of the line.
+     * @param parts Bytes (`const char *`) and length (`int64_t`) of each string.
+     */
+    static void printLine(int count, va_list parts);
+
+    /// Stops the writer and writes every pending line, the event threads must be stopped before this call.
+    static void stop();
+};
@@ -0,0 +1,198 @@
+#include "Realtime.h"
+#include "spdlog/spdlog.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+bool Realtime::enabled = false;
+int Realtime::priority = Realtime::DEFAULT_PRIORITY;
+
+std::vector<int> &Realtime::cpus() {
+    static std::vector<int> list;
+    return list;
+}
+
+/**
+ * @brief Parses a CPU list like `2,3` or `0-3,6`.
+ * @param list Text of the list.
+ * @return CPUs of the list, empty if it is invalid.
+ */
+static std::vector<int> parseCpuList(const std::string &list) {
+    std::vector<int> result;
+    std::size_t pos = 0;
+
+    while (pos < list.size()) {
+        std::size_t end = list.find(',', pos);
+        std::string range = list.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+        pos = end == std::string::npos ? list.size() : end + 1;
+
+        try {
+            std::size_t dash = range.find('-');
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            if (first < 0 || last < first || last >= CPU_SETSIZE)
+                return {};
+
+            for (int cpu = first; cpu <= last; ++cpu) {
+                result.push_back(cpu);
+            }
+        } catch (const std::exception &) {
+            return {};
+        }
+    }
+
+    return result;
+}
+
+bool Realtime::startFromEnv() {
+    const char *env = std::getenv("T_RT");
+    if (!env || std::string(env) == "0")
+        return false;
+
+    enable();
+    return true;
+}
+
+void Realtime::enable() {
+    if (enabled)
+        return;
+    enabled = true;
+
+    // Invalid values keep the defaults
+    if (const char *env = std::getenv("T_RT_CPUS")) {
+        cpus() = parseCpuList(env);
+        if (cpus().empty())
+            spdlog::warn("Invalid T_RT_CPUS value: {}", env);
+    }
+
+    if (const char *env = std::getenv("T_RT_PRIORITY")) {
+        try {
+            priority = std::stoi(env);
+        } catch (const std::exception &) {
+            spdlog::warn("Invalid T_RT_PRIORITY value: {}", env);
+        }
+    }
+
+    // The timer thread takes the priority above the workers
+    priority = std::clamp(priority, sched_get_priority_min(SCHED_FIFO), sched_get_priority_max(SCHED_FIFO) - 1);
+
+    prepareMemory();
+}
+
+void Realtime::prepareMemory() {
+    std::size_t heapMb = DEFAULT_HEAP_MB;
+    if (const char *env = std::getenv("T_RT_HEAP")) {
+        try {
+            heapMb = static_cast<std::size_t>(std::max(0L, std::stol(env)));
+        } catch (const std::exception &) {
+            spdlog::warn("Invalid T_RT_HEAP value: {}", env);
+        }
+    }
+
+    // Under a memlock limit the later stacks and allocations would fail once locked, only unlimited processes lock
+    std::string locked;
+    rlimit limit;
+    getrlimit(RLIMIT_MEMLOCK, &limit);
+    if (limit.rlim_cur != RLIM_INFINITY && geteuid() != 0) {
+        locked = "not locked (RLIMIT_MEMLOCK " + std::to_string(limit.rlim_cur / 1024) + " KB)";
+    } else if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        locked = std::string("not locked (") + std::strerror(errno) + ")";
+    } else {
+        locked = "locked";
+    }
+
+    // Freed memory stays in a single heap, so the prefaulted pages are the ones reused by every thread
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+    mallopt(M_ARENA_MAX, 1);
+
+    std::size_t bytes = heapMb * 1024 * 1024;
+    long page = sysconf(_SC_PAGESIZE);
+    if (char *heap = static_cast<char *>(std::malloc(bytes))) {
+        for (std::size_t i = 0; i < bytes; i += static_cast<std::size_t>(page)) {
+            heap[i] = 0;
+        }
+        std::free(heap);
+    }
+
+    prefaultStack();
+
+    std::cerr << "Real-time mode: memory " << locked << ", heap prefaulted " << heapMb << " MB, stacks prefaulted "
+              << STACK_PREFAULT / 1024 << " KB\n";
+}
+
+void Realtime::prefaultStack() {
+    if (!enabled)
+        return;
+
+    // Written through a volatile pointer so the writes are not removed, one per page is enough to map it
+    unsigned char stack[STACK_PREFAULT];
+    volatile unsigned char *touch = stack;
+    long page = sysconf(_SC_PAGESIZE);
+    for (std::size_t i = 0; i < STACK_PREFAULT; i += static_cast<std::size_t>(page)) {
+        touch[i] = 0;
+    }
+}
+
+void Realtime::configureThreads(std::thread &timer, std::vector<std::thread> &workers) {
+    if (!enabled)
+        return;
+
+    // One CPU per worker in turn, the timer thread may run in any of them
+    const std::vector<int> &list = cpus();
+    std::string pinned = "not pinned";
+    if (!list.empty()) {
+        int failed = 0;
+        cpu_set_t all;
+        CPU_ZERO(&all);
+        for (int cpu : list) {
+            CPU_SET(cpu, &all);
+        }
+
+        for (std::size_t i = 0; i < workers.size(); ++i) {
+            cpu_set_t one;
+            CPU_ZERO(&one);
+            CPU_SET(list[i % list.size()], &one);
+            failed = failed ? failed : pthread_setaffinity_np(workers[i].native_handle(), sizeof(one), &one);
+        }
+        failed = failed ? failed : pthread_setaffinity_np(timer.native_handle(), sizeof(all), &all);
+
+        std::string names;
+        for (int cpu : list) {
+            names += (names.empty() ? "" : ",") + std::to_string(cpu);
+        }
+        pinned = failed ? "not pinned to CPUs " + names + " (" + std::strerror(failed) + ")" : "pinned to CPUs " + names;
+    }
+
+    // A single refusal keeps every thread in the normal policy, the workers never preempt the timer thread
+    sched_param param{};
+    param.sched_priority = priority + 1;
+    int failed = pthread_setschedparam(timer.native_handle(), SCHED_FIFO, &param);
+
+    param.sched_priority = priority;
+    for (std::size_t i = 0; !failed && i < workers.size(); ++i) {
+        failed = pthread_setschedparam(workers[i].native_handle(), SCHED_FIFO, &param);
+    }
+
+    std::string scheduling = "SCHED_FIFO priority " + std::to_string(priority) + " (timer " +
+                             std::to_string(priority + 1) + ")";
+    if (failed) {
+        sched_param normal{};
+        pthread_setschedparam(timer.native_handle(), SCHED_OTHER, &normal);
+        for (std::thread &worker : workers) {
+            pthread_setschedparam(worker.native_handle(), SCHED_OTHER, &normal);
+        }
+        scheduling = std::string("normal scheduling (SCHED_FIFO: ") + std::strerror(failed) + ")";
+    }
+
+    std::cerr << "Real-time mode: " << workers.size() << " workers " << pinned << ", " << scheduling << "\n";
+}
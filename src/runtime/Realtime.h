@@ -0,0 +1,67 @@
+/**
+ * @file Realtime.h
+ * @brief Contains the definition of the low-latency real-time mode of the runtime.
+ *
+ * Enabled with the `T_RT` environment variable or the `--realtime` compiler flag, it
+ * removes the memory manager and the migrations from the activation latency:
+ * - the memory of the process is locked (`mlockall`) and the heap is prefaulted,
+ * - every runtime thread prefaults its stack before running any event,
+ * - the workers are pinned to the CPUs of `T_RT_CPUS`, one CPU each in turn,
+ * - the runtime threads run with `SCHED_FIFO` at `T_RT_PRIORITY` if the process is allowed.
+ *
+ * Each setting falls back to the normal behaviour when it is not permitted, and the
+ * settings actually obtained are reported in the standard error.
+ *
+ * @author Adrián Zamora Sánchez
+ * @see Scheduler.h
+ */
+
+#pragma once
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/// Process-wide real-time settings, applied once at startup and to each runtime thread.
+class Realtime {
+    static constexpr std::size_t STACK_PREFAULT = 256 * 1024; ///< Bytes of stack touched by each runtime thread
+    static constexpr int DEFAULT_PRIORITY = 50;               ///< `SCHED_FIFO` priority of the workers
+    static constexpr std::size_t DEFAULT_HEAP_MB = 16;        ///< Heap prefaulted at startup, in MB
+
+    static bool enabled; ///< Set once at startup, before any runtime thread is created
+    static int priority; ///< `SCHED_FIFO` priority of the workers, the timer thread gets the next one
+
+    /**
+     * @brief Getter for the CPUs of the workers, a function static so it is set before the global runtime is built.
+     * @return CPUs of the workers, empty if they are not pinned.
+     */
+    static std::vector<int> &cpus();
+
+    /// Locks the memory of the process and prefaults the heap and the stack of the calling thread.
+    static void prepareMemory();
+
+  public:
+    /**
+     * @brief Enables the real-time mode if the `T_RT` environment variable is set.
+     * @return `true` if the mode is enabled.
+     */
+    static bool startFromEnv();
+
+    /// Enables the real-time mode with `T_RT_CPUS`, `T_RT_PRIORITY` and `T_RT_HEAP`, only the first call has effect.
+    static void enable();
+
+    /**
+     * @brief Getter for the enabled flag.
+     * @return `true` if the runtime threads must be configured.
+     */
+    static bool isEnabled() { return enabled; }
+
+    /// Touches the stack of the calling thread so its pages are mapped before the first activation.
+    static void prefaultStack();
+
+    /**
+     * @brief Pins and prioritizes the runtime threads before they enter their loops, reporting the result.
+     * @param timer Timer thread, it gets a priority above the workers.
+     * @param workers Worker pool.
+     */
+    static void configureThreads(std::thread &timer, std::vector<std::thread> &workers);
+};
@@ -1,65 +1,228 @@
 #include "Runtime.h"
+#include "Output.h"
+#include "Realtime.h"
+#include "Trace.h"
+#include <csignal>
+#include <cstdlib>
 #include <iostream>
+#include <pthread.h>
+#include <thread>
+
+Runtime::Runtime()
+    : scheduler(Scheduler::workerCountFromEnv(), Scheduler::spinFromEnv(), Scheduler::dispatchFromEnv()) {
+    // Memory is locked and prefaulted before any other thread of the runtime exists
+    Realtime::startFromEnv();
+
+    Scheduler::Clock::duration horizon;
+    if (Scheduler::virtualTimeFromEnv(horizon))
+        scheduler.useVirtualTime(horizon);
+    if (Scheduler::staggerFromEnv())
+        scheduler.enableStagger();
+
+    const char *env = std::getenv("T_STATS");
+    statsEnabled = env && std::string(env) != "0";
+
+    if (statsEnabled)
+        startStatsSignalThread();
+
+    Trace::startFromEnv();
+    Output::configureFromEnv();
+}
+
+Runtime::~Runtime() {
+    // A signal during the teardown would print a registry being destroyed
+    if (statsThread.joinable()) {
+        statsStopping = true;
+        pthread_kill(statsThread.native_handle(), SIGUSR1);
+        statsThread.join();
+    }
+
+    // The workers are joined before reading the histograms
+    scheduler.stop();
+
+    if (statsEnabled)
+        printStats(std::cerr);
+
+    Trace::write();
+    Output::stop();
+}
+
+void Runtime::startStatsSignalThread() {
+    // Blocked in this thread and in every thread created later, so only the waiter receives it
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    statsThread = std::thread([this, signals]() {
+        int signal;
+        while (sigwait(&signals, &signal) == 0 && !statsStopping) {
+            printStats(std::cerr);
+        }
+    });
+}
 
 Runtime &Runtime::get() {
     static Runtime instance;
     return instance;
 }
 
-void Runtime::checkEvents() {
-    for (int i = 0; i < events.size();) {
-        if (!events[i]->getEventRunningFlag()) {
-            events[i]->stopEvent();
-            events.erase(events.begin() + i);
-        } else {
-            ++i;
-        }
+EventHandle Runtime::registerEvent(const char *id,
+                                   std::chrono::microseconds period,
+                                   Event::EventThunk thunk,
+                                   int argCount,
+                                   const int *argTypes,
+                                   int limit,
+                                   EventKind kind,
+                                   Overrun overrun,
+                                   int priority) {
+    EventHandle handle = events.add(id, period, thunk, argCount, argTypes, limit, kind);
+
+    if (Event *ev = events.get(handle)) {
+        ev->setOverrun(overrun);
+        ev->setPriority(priority);
+        if (statsEnabled)
+            ev->enableStats();
     }
-};
 
-using EventFn = void (*)();
+    return handle;
+}
+
+EventHandle Runtime::registerWhenEvent(const char *id, Event::EventThunk thunk) {
+    // One activation each time the condition becomes true
+    EventHandle handle =
+        events.add(id, std::chrono::microseconds::zero(), thunk, 0, nullptr, 0, EventKind::WHEN);
 
-void Runtime::registerEvent(std::string id, float period, EventFn fnPtr, int argCount, const int *argTypes, int limit) {
-    events.emplace_back(std::make_shared<Event>(id, period, fnPtr, argCount, argTypes, limit));
+    if (statsEnabled) {
+        if (Event *ev = events.get(handle))
+            ev->enableStats();
+    }
+
+    return handle;
 }
 
-void Runtime::terminateEvent(std::string id) {
-    std::shared_ptr<Event> eventToTerminate;
+void Runtime::updateCondition(EventHandle handle, bool value) {
+    Event *ev = events.get(handle);
+    if (!ev)
+        return; // Event not found or terminated
 
-    {
-        // Operation under mutex
-        std::lock_guard<std::mutex> lock(eventsMutex);
+    // Only the change from false to true activates the event
+    if (ev->updateCondition(value))
+        scheduler.activate(ev);
+}
 
-        // Search the event in the list
-        auto it = std::find_if(events.begin(), events.end(),
-                               [&](const std::shared_ptr<Event> &e) { return e->getID() == id; });
+void Runtime::setQueue(EventHandle handle, std::size_t capacity, QueueFull policy) {
+    if (Event *ev = events.get(handle))
+        ev->enableQueue(capacity, policy);
+}
 
-        if (it == events.end()) {
-            return; // Event not found
-        }
+void Runtime::setSlack(EventHandle handle, std::chrono::microseconds slack) {
+    if (Event *ev = events.get(handle))
+        ev->setSlack(slack);
+}
 
-        // Removes the event from the list
-        eventToTerminate = *it;
-        events.erase(it);
-    }
+void Runtime::setAligned(EventHandle handle) {
+    if (Event *ev = events.get(handle))
+        ev->setAligned();
+}
+
+void Runtime::terminateEvent(EventHandle handle) {
+    // Invalidates the handle, only the first terminator gets the event
+    Event *eventToTerminate = events.release(handle);
+    if (!eventToTerminate)
+        return; // Event not found
 
     // Event stop signal
-    eventToTerminate->stopEvent();
+    scheduler.cancel(*eventToTerminate);
 }
 
 void Runtime::printEventList() {
     spdlog::debug("\nPrinting events {} in the list:", std::to_string(events.size()));
-    for (const auto &ev : events) {
-        ev->print();
+    events.forEach([](Event &ev) { ev.print(); });
+}
+
+void Runtime::scheduleEvent(EventHandle handle, void **argv) {
+    Event *eventToSchedule = events.get(handle);
+    if (!eventToSchedule)
+        return; // Event not found
+
+    eventToSchedule->setArgsCopy(argv, scheduler.mayBlock());
+
+    // First activation runs as soon as a worker is available
+    scheduler.activate(eventToSchedule);
+}
+
+/// Events batched by the current thread, kept as handles so the ones terminated before the flush are skipped.
+static std::vector<EventHandle> &threadBatch() {
+    static thread_local std::vector<EventHandle> batch;
+    return batch;
+}
+
+void Runtime::batchEvent(EventHandle handle, void **argv) {
+    Event *ev = events.get(handle);
+    if (!ev)
+        return; // Event not found
+
+    // A blocking queue needs its consumer running, queued events are not deferred
+    if (ev->isQueued()) {
+        ev->setArgsCopy(argv, scheduler.mayBlock());
+        scheduler.activate(ev);
+        return;
+    }
+
+    // The arguments are published now, a loop that schedules the same event keeps its last values
+    ev->setArgsCopy(argv);
+
+    std::vector<EventHandle> &batch = threadBatch();
+    if (batch.empty() || batch.back() != handle)
+        batch.push_back(handle);
+}
+
+void Runtime::flushBatch() {
+    std::vector<EventHandle> &batch = threadBatch();
+    if (batch.empty())
+        return;
+
+    static thread_local std::vector<Event *> ready;
+    for (EventHandle handle : batch) {
+        if (Event *ev = events.get(handle))
+            ready.push_back(ev);
     }
+    batch.clear();
+
+    scheduler.activate(ready);
+    ready.clear();
 }
 
-void Runtime::scheduleEvent(std::string id, void **argv) {
-    for (auto &e : events) {
-        if (e->getID() == id) {
-            e->setArgsCopy(argv);
-            e->startEvent();
+void Runtime::printStats(std::ostream &out) {
+    auto us = [](std::chrono::nanoseconds value) { return fmt::format("{:.1f}", value.count() / 1000.0); };
+
+    out << "Event statistics (us): count p50 p90 p99 p99.9 max\n";
+    events.forEach([&](Event &ev) {
+        const EventStats *stats = ev.getStats();
+        if (!stats)
             return;
-        }
-    }
-}
\ No newline at end of file
+
+        out << ev.getID() << " (activations: " << stats->lateness.getCount()
+            << ", missed deadlines: " << ev.getMissedDeadlines();
+        if (ev.isQueued())
+            out << ", dropped arguments: " << ev.getDroppedArgs();
+        out << ")\n";
+
+        // One line per histogram
+        auto printHistogram = [&](const char *name, const Histogram &histogram) {
+            out << "  " << name << ": " << histogram.getCount() << " " << us(histogram.getPercentile(50)) << " "
+                << us(histogram.getPercentile(90)) << " " << us(histogram.getPercentile(99)) << " "
+                << us(histogram.getPercentile(99.9)) << " " << us(histogram.getMax()) << "\n";
+        };
+        printHistogram("lateness ", stats->lateness);
+        printHistogram("wall time", stats->wallTime);
+        printHistogram("cpu time ", stats->cpuTime);
+    });
+
+    // The events with slack share the wake ups of the timer thread
+    TimerStats timer = scheduler.getTimerStats();
+    out << "Timer wake ups: " << timer.wakeups << " (activations: " << timer.activations
+        << ", coalesced: " << timer.coalesced << ", slack used: " << us(timer.slackUsed) << " us)\n";
+    out.flush();
+}
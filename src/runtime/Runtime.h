@@ -7,22 +7,46 @@
 
 #pragma once
 #include "Event.h"
+#include "EventRegistry.h"
+#include "Scheduler.h"
 #include "spdlog/spdlog.h"
+#include <atomic>
 #include <memory>
 #include <mutex>
+#include <thread>
 #include <vector>
 
 /// Class for the language runtime structure.
 class Runtime {
     using Fn = void (*)(void *frame);
 
-    std::vector<std::shared_ptr<Event>> events; ///< List of events
-    std::mutex eventsMutex;                     ///< Mutex for concurrent operations
-    bool running = true;                        ///< Running flag
+    EventRegistry events;                   ///< Slot map of the registered events
+    bool running = true;                    ///< Running flag
+    bool statsEnabled = false;              ///< Timing histograms enabled by the `T_STATS` environment variable
+    std::thread statsThread;                ///< Waits for `SIGUSR1` while the statistics are enabled
+    std::atomic<bool> statsStopping{false}; ///< Set before waking the statistics thread for the last time
+    Scheduler scheduler;                    ///< Timer queue and worker pool, declared last to stop first
+
+    /// Starts a thread that prints the statistics each time the process receives `SIGUSR1`.
+    void startStatsSignalThread();
 
   public:
-    /// Default constructor.
-    Runtime(){};
+    /**
+     * @brief Default constructor, the worker count is read from the `T_WORKERS` environment variable.
+     *
+     * If `T_STATS` is set the events record timing histograms, printed at exit and on `SIGUSR1`.
+     * If `T_TRACE` is set the activations are written at exit as a Chrome trace.
+     * If `T_VIRTUAL` is set the events run on the main thread with a simulated clock.
+     * If `T_STAGGER` is set the periodic events with the same period get spread phases.
+     */
+    Runtime();
+
+    /**
+     * @brief Runtime destructor, joins the statistics thread and stops the scheduler.
+     *
+     * Then prints the statistics and writes the trace if they are enabled.
+     */
+    ~Runtime();
 
     /**
      * @brief Getter for the static item.
@@ -31,46 +55,121 @@ class Runtime {
     static Runtime &get();
 
     /**
-     * @brief Executes an event.
-     * @param ev Event to execute.
+     * @brief Terminates a event, the handle is no longer valid after this call.
+     * @param handle Handle of the event to terminate.
      */
-    void launchEventThread(std::shared_ptr<Event> ev);
+    void terminateEvent(EventHandle handle);
 
     /**
-     * @brief Terminates a event.
-     * @param id Given event identifier.
+     * @brief Schredule a registered event.
+     * @param handle Handle of the Event to schedule.
+     * @param argv Arguments for the event execution.
      */
-    void terminateEvent(std::string id);
+    void scheduleEvent(EventHandle handle, void **argv);
 
     /**
-     * @brief Schredule a registered event.
-     * @param id of the Event to schedule.
+     * @brief Publishes the arguments of a event and adds it to the batch of the calling thread.
+     *
+     * The batched events are activated together by flushBatch, taking the scheduler locks once.
+     *
+     * @param handle Handle of the Event to schedule.
+     * @param argv Arguments for the event execution.
      */
-    void scheduleEvent(std::string id, void **argv);
+    void batchEvent(EventHandle handle, void **argv);
+
+    /// Activates the events batched by the calling thread.
+    void flushBatch();
+
+    /**
+     * @brief Updates the condition of a `when` event, activating it once if the condition became true.
+     * @param handle Handle of the event.
+     * @param value Result of evaluating the condition.
+     */
+    void updateCondition(EventHandle handle, bool value);
+
+    /// Blocks the calling thread until every scheduled event has finished.
+    void waitForEvents() {
+        flushBatch();
+        scheduler.waitIdle();
+    };
 
     /**
-     * Checks the current Event status and manages the event list.
+     * @brief Handle lookup, for the tools that inspect the events of the runtime.
+     * @param handle Handle of the Event.
+     * @return Event, or nullptr if the handle is not valid.
      */
-    void checkEvents();
+    Event *getEvent(EventHandle handle) const { return events.get(handle); }
 
     /**
      * @brief Return the size of the Event list.
      * @return Amount of registered events.
      */
-    int getEventCount() { return events.size(); };
+    int getEventCount() { return static_cast<int>(events.size()); };
 
-    using EventFn = void (*)();
     /**
      * @brief Saves the event data.
-     * @param id Identifier of the new Event.
+     * @param id Identifier of the new Event, used in place.
      * @param period Time period of the new Event.
-     * @param fnPtr Compilated event function name.
+     * @param thunk Compiled trampoline of the event function.
      * @param argCount Number of parameters of the function signature.
      * @param argTypes Types of the function parameters.
      * @param limit Number of limit executions for this Event, if set to 0 it has no numeric limit.
+     * @param kind Periodic (`every`) or single activation timer (`at`, `after`).
+     * @param overrun Behaviour of a periodic Event when its body runs longer than the period.
+     * @param priority Dispatch priority, higher values run first when the workers are busy.
+     * @return Handle of the new Event, 0 if it could not be registered.
+     */
+    EventHandle registerEvent(const char *id,
+                              std::chrono::microseconds period,
+                              Event::EventThunk thunk,
+                              int argCount,
+                              const int *argTypes,
+                              int limit,
+                              EventKind kind = EventKind::EVERY,
+                              Overrun overrun = Overrun::SKIP,
+                              int priority = 0);
+
+    /**
+     * @brief Switches a event to queued mode, each schedule call adds a argument tuple for one activation.
+     * @param handle Handle of the Event, before its first schedule call.
+     * @param capacity Maximum number of pending argument tuples.
+     * @param policy Behaviour when a tuple is added to a full queue.
      */
-    void registerEvent(std::string id, float period, EventFn fnPtr, int argCount, const int *argTypes, int limit);
+    void setQueue(EventHandle handle, std::size_t capacity, QueueFull policy);
+
+    /**
+     * @brief Sets the slack of a event, its activations may be delayed to share the timer wake ups.
+     * @param handle Handle of the Event, before its first schedule call.
+     * @param slack Delay allowed after each due time.
+     */
+    void setSlack(EventHandle handle, std::chrono::microseconds slack);
+
+    /**
+     * @brief Excludes a event from the phase staggering.
+     * @param handle Handle of the Event, before its first schedule call.
+     */
+    void setAligned(EventHandle handle);
+
+    /**
+     * @brief Getter for the timer counters.
+     * @return Wake ups of the timer thread and slack used by the activations.
+     */
+    TimerStats getTimerStats() const { return scheduler.getTimerStats(); }
+
+    /**
+     * @brief Saves the data of a event activated by a condition.
+     * @param id Identifier of the new Event, used in place.
+     * @param thunk Compiled trampoline of the event function.
+     * @return Handle of the new Event, 0 if it could not be registered.
+     */
+    EventHandle registerWhenEvent(const char *id, Event::EventThunk thunk);
 
     /// Prints the event list data.
     void printEventList();
+
+    /**
+     * @brief Prints the timing histograms of every event.
+     * @param out Output stream.
+     */
+    void printStats(std::ostream &out);
 };
\ No newline at end of file
@@ -0,0 +1,485 @@
+#include "Scheduler.h"
+#include "Realtime.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <ctime>
+#include <future>
+#include <string>
+#include <sys/prctl.h>
+
+Scheduler::Scheduler(unsigned workers, Clock::duration spin, Dispatch dispatch)
+    : dispatch(dispatch), epoch(Clock::now()), spin(spin), virtualNow(epoch), horizon(Clock::duration::max()),
+      workerCount(workers) {
+    if (workerCount == 0) {
+        workerCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+Scheduler::~Scheduler() {
+    stop();
+}
+
+unsigned Scheduler::workerCountFromEnv() {
+    const char *env = std::getenv("T_WORKERS");
+    if (!env)
+        return 0;
+
+    // Invalid values fall back to the number of cores
+    try {
+        int count = std::stoi(env);
+        return count > 0 ? static_cast<unsigned>(count) : 0;
+    } catch (const std::exception &) {
+        spdlog::warn("Invalid T_WORKERS value: {}", env);
+        return 0;
+    }
+}
+
+Scheduler::Clock::duration Scheduler::spinFromEnv() {
+    const char *env = std::getenv("T_SPIN");
+    if (!env)
+        return Clock::duration::zero();
+
+    // Invalid values disable the spinning
+    try {
+        int micros = std::stoi(env);
+        return std::chrono::microseconds(std::max(0, micros));
+    } catch (const std::exception &) {
+        spdlog::warn("Invalid T_SPIN value: {}", env);
+        return Clock::duration::zero();
+    }
+}
+
+bool Scheduler::virtualTimeFromEnv(Clock::duration &limit) {
+    const char *env = std::getenv("T_VIRTUAL");
+    if (!env || std::string(env) == "0")
+        return false;
+
+    limit = Clock::duration::max();
+    const char *horizonEnv = std::getenv("T_VIRTUAL_HORIZON");
+    if (!horizonEnv)
+        return true;
+
+    // Invalid values run the simulation without limit
+    try {
+        double seconds = std::stod(horizonEnv);
+        if (seconds >= 0)
+            limit = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    } catch (const std::exception &) {
+        spdlog::warn("Invalid T_VIRTUAL_HORIZON value: {}", horizonEnv);
+    }
+    return true;
+}
+
+bool Scheduler::staggerFromEnv() {
+    const char *env = std::getenv("T_STAGGER");
+    return env && std::string(env) != "0";
+}
+
+Dispatch Scheduler::dispatchFromEnv() {
+    const char *env = std::getenv("T_DISPATCH");
+    if (!env)
+        return Dispatch::PRIORITY;
+
+    std::string policy(env);
+    if (policy == "edf")
+        return Dispatch::EDF;
+    if (policy != "priority")
+        spdlog::warn("Invalid T_DISPATCH value: {}", env);
+
+    return Dispatch::PRIORITY;
+}
+
+void Scheduler::useVirtualTime(Clock::duration limit) {
+    virtualTime = true;
+    virtualNow = epoch;
+    horizon = limit;
+}
+
+void Scheduler::start() {
+    // The virtual clock runs the activations in the thread that waits for them
+    if (virtualTime)
+        return;
+
+    std::call_once(startFlag, [this]() {
+        // The threads wait for their CPU and priority before taking any activation
+        std::promise<void> configured;
+        std::shared_future<void> ready = configured.get_future().share();
+
+        timerThread = std::thread([this, ready]() {
+            Realtime::prefaultStack();
+            ready.wait();
+            timerLoop();
+        });
+
+        workers.reserve(workerCount);
+        for (unsigned i = 0; i < workerCount; ++i) {
+            workers.emplace_back([this, ready]() {
+                Realtime::prefaultStack();
+                ready.wait();
+                workerLoop();
+            });
+        }
+
+        Realtime::configureThreads(timerThread, workers);
+        configured.set_value();
+    });
+}
+
+void Scheduler::stop() {
+    {
+        std::scoped_lock lock(timersMutex, readyMutex);
+        if (stopping)
+            return;
+        stopping = true;
+    }
+
+    timersCv.notify_all();
+    readyCv.notify_all();
+
+    if (timerThread.joinable())
+        timerThread.join();
+
+    for (auto &worker : workers) {
+        if (worker.joinable())
+            worker.join();
+    }
+}
+
+void Scheduler::activate(Event *ev) {
+    std::uint32_t generation;
+
+    // Counted before the event is published as armed, so a concurrent cancel always retires a counted event
+    {
+        std::lock_guard<std::mutex> lock(liveMutex);
+        ++liveEvents;
+        if (!ev->startEvent(generation)) {
+            if (--liveEvents == 0)
+                liveCv.notify_all();
+            return;
+        }
+    }
+
+    start();
+    Clock::time_point time = now();
+    ev->resetDeadline(time, epoch, phaseOf(ev, time));
+    arm(ev, ev->getDeadline(), generation);
+}
+
+void Scheduler::activate(std::vector<Event *> &batch) {
+    // Arm generation of each started event, in the order of the batch
+    static thread_local std::vector<std::uint32_t> generations;
+
+    // Counted before they are published as armed, the events already running are dropped from the batch
+    {
+        std::lock_guard<std::mutex> lock(liveMutex);
+        std::size_t requested = batch.size();
+        liveEvents += static_cast<int>(requested);
+
+        std::size_t kept = 0;
+        generations.resize(requested);
+        for (Event *ev : batch) {
+            if (ev->startEvent(generations[kept]))
+                batch[kept++] = ev;
+        }
+        batch.resize(kept);
+
+        liveEvents -= static_cast<int>(requested - batch.size());
+        if (liveEvents == 0)
+            liveCv.notify_all();
+    }
+    if (batch.empty())
+        return;
+
+    start();
+    Clock::time_point time = now();
+    bool earliest = false;
+
+    {
+        std::lock_guard<std::mutex> lock(timersMutex);
+        if (stopping)
+            return;
+
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            Event *ev = batch[i];
+            ev->resetDeadline(time, epoch, phaseOf(ev, time));
+            TimerEntry entry = makeEntry(ev, ev->getDeadline(), generations[i]);
+            earliest = earliest || timers.empty() || entry.latest < timers.top().latest;
+            timers.push(entry);
+        }
+    }
+
+    // A single wake up for the whole batch
+    if (earliest)
+        timersCv.notify_one();
+}
+
+Scheduler::Clock::duration Scheduler::phaseOf(Event *ev, Clock::time_point now) {
+    Clock::duration period = ev->getPeriod();
+    if (!stagger || ev->isAligned() || ev->getKind() != EventKind::EVERY || period <= Clock::duration::zero())
+        return Clock::duration::zero();
+
+    std::uint32_t slot;
+    {
+        std::lock_guard<std::mutex> lock(phaseMutex);
+        slot = phaseSlots[ev->getPeriod().count()]++;
+    }
+
+    // Bit reversed slot (van der Corput sequence), any number of events is spread evenly: 0, 1/2, 1/4, 3/4...
+    std::uint32_t reversed = 0;
+    for (int bit = 0; bit < 32; ++bit) {
+        reversed = (reversed << 1) | ((slot >> bit) & 1);
+    }
+    auto offset = Clock::duration(static_cast<Clock::rep>(period.count() * (reversed / 4294967296.0)));
+
+    // The offset is measured from the program start, so the events scheduled later keep the spread
+    Clock::duration elapsed = (now - epoch) % period;
+    return (offset - elapsed + period) % period;
+}
+
+void Scheduler::cancel(Event &ev) {
+    // Only a event waiting in the timer queue is retired here, otherwise its worker does it
+    if (ev.stopEvent())
+        retire();
+}
+
+void Scheduler::waitIdle() {
+    if (virtualTime) {
+        runVirtual();
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(liveMutex);
+    liveCv.wait(lock, [this]() { return liveEvents == 0; });
+}
+
+void Scheduler::retire() {
+    std::lock_guard<std::mutex> lock(liveMutex);
+    if (--liveEvents == 0)
+        liveCv.notify_all();
+}
+
+void Scheduler::arm(Event *ev, Clock::time_point due, std::uint32_t generation) {
+    bool earliest;
+
+    {
+        std::lock_guard<std::mutex> lock(timersMutex);
+        if (stopping)
+            return;
+
+        TimerEntry entry = makeEntry(ev, due, generation);
+        earliest = timers.empty() || entry.latest < timers.top().latest;
+        timers.push(entry);
+    }
+
+    // The timer thread only needs to wake up if its next deadline changed
+    if (earliest)
+        timersCv.notify_one();
+}
+
+void Scheduler::sleepUntil(Clock::time_point due) const {
+    // steady_clock is CLOCK_MONOTONIC, its time points are valid absolute times for clock_nanosleep
+    Clock::time_point wake = due - spin;
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(wake.time_since_epoch()).count();
+    timespec ts{static_cast<time_t>(ns / 1000000000), static_cast<long>(ns % 1000000000)};
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+
+    // The wake up latency of the kernel is larger than the spin time, the rest is busy waited
+    while (Clock::now() < due) {
+    }
+}
+
+bool Scheduler::runsAfter(const ReadyEntry &a, const ReadyEntry &b) const {
+    if (dispatch == Dispatch::EDF) {
+        if (a.deadline != b.deadline)
+            return a.deadline > b.deadline;
+    } else if (a.priority != b.priority) {
+        return a.priority < b.priority;
+    }
+
+    return a.seq > b.seq;
+}
+
+void Scheduler::timerLoop() {
+    std::vector<TimerEntry> due;
+    std::unique_lock<std::mutex> lock(timersMutex);
+
+    // Without slack the kernel wakes the timer thread at the requested time instead of grouping timers
+    prctl(PR_SET_TIMERSLACK, 1UL);
+
+    while (!stopping) {
+        if (timers.empty()) {
+            timersCv.wait(lock);
+            continue;
+        }
+
+        // Sleeps until the earliest latest time or a new earlier one is armed, the slack is only used to wait longer
+        Clock::time_point next = timers.top().latest;
+        Clock::time_point now = Clock::now();
+        if (next - now > PRECISE_WINDOW) {
+            timersCv.wait_until(lock, next - PRECISE_WINDOW);
+            continue;
+        }
+
+        // Near deadlines are slept on the absolute time, a earlier arm in the meantime waits at most the window
+        if (next > now) {
+            lock.unlock();
+            sleepUntil(next);
+            lock.lock();
+            continue;
+        }
+
+        // Collects every entry that is already due, in latest time order a due entry behind one that is not waits
+        // for a later wake up, still inside its slack
+        while (!timers.empty() && timers.top().due <= now) {
+            // Entries of a cancelled timer chain are dropped, the event may be running a newer one
+            if (timers.top().generation == timers.top().event->getArmGeneration())
+                due.push_back(timers.top());
+            timers.pop();
+        }
+        if (due.empty())
+            continue;
+        lock.unlock();
+
+        // Wake up counters, single writer
+        std::uint64_t shared = 0;
+        std::int64_t slackUsed = 0;
+        for (const TimerEntry &entry : due) {
+            if (entry.latest == entry.due)
+                continue;
+            slackUsed += std::chrono::duration_cast<std::chrono::nanoseconds>(std::min(now, entry.latest) - entry.due)
+                             .count();
+            if (now < entry.latest)
+                ++shared;
+        }
+        timerWakeups.store(timerWakeups.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        timerActivations.store(timerActivations.load(std::memory_order_relaxed) + due.size(),
+                               std::memory_order_relaxed);
+        coalesced.store(coalesced.load(std::memory_order_relaxed) + shared, std::memory_order_relaxed);
+        slackUsedNs.store(slackUsedNs.load(std::memory_order_relaxed) + slackUsed, std::memory_order_relaxed);
+
+        // Hands the due events to the worker pool, a periodic event should finish before its next activation
+        {
+            std::lock_guard<std::mutex> readyLock(readyMutex);
+            auto order = [this](const ReadyEntry &a, const ReadyEntry &b) { return runsAfter(a, b); };
+            for (const TimerEntry &entry : due) {
+                Event *ev = entry.event;
+                Clock::time_point deadline = entry.due;
+                if (ev->getKind() == EventKind::EVERY)
+                    deadline += ev->getPeriod();
+
+                ready.push_back({deadline, ev->getPriority(), entry.seq, ev, entry.generation});
+                std::push_heap(ready.begin(), ready.end(), order);
+            }
+        }
+        if (due.size() == 1) {
+            readyCv.notify_one();
+        } else {
+            readyCv.notify_all();
+        }
+        due.clear();
+
+        lock.lock();
+    }
+}
+
+TimerStats Scheduler::getTimerStats() const {
+    TimerStats stats;
+    stats.wakeups = timerWakeups.load(std::memory_order_relaxed);
+    stats.activations = timerActivations.load(std::memory_order_relaxed);
+    stats.coalesced = coalesced.load(std::memory_order_relaxed);
+    stats.slackUsed = std::chrono::nanoseconds(slackUsedNs.load(std::memory_order_relaxed));
+    return stats;
+}
+
+/// Set in the worker threads, their activations can not wait for other activations.
+static thread_local bool onWorker = false;
+
+bool Scheduler::mayBlock() const {
+    return !virtualTime && !onWorker;
+}
+
+void Scheduler::workerLoop() {
+    onWorker = true;
+
+    while (true) {
+        Event *ev;
+        std::uint32_t generation;
+
+        {
+            std::unique_lock<std::mutex> lock(readyMutex);
+            readyCv.wait(lock, [this]() { return stopping || !ready.empty(); });
+
+            if (stopping)
+                return;
+
+            std::pop_heap(ready.begin(), ready.end(),
+                          [this](const ReadyEntry &a, const ReadyEntry &b) { return runsAfter(a, b); });
+            ev = ready.back().event;
+            generation = ready.back().generation;
+            ready.pop_back();
+        }
+
+        runActivation(ev, generation);
+    }
+}
+
+void Scheduler::runActivation(Event *ev, std::uint32_t generation) {
+    // A cancel after the check of the timer thread, beginActivation repeats it atomically with the state change
+    if (generation != ev->getArmGeneration())
+        return;
+
+    if (ev->isSuspended()) {
+        // Next slice of a coroutine activation, a stop requested meanwhile ends it at the suspension point
+        if (ev->isStopping()) {
+            ev->destroyCoroutine();
+        } else {
+            ev->execute();
+        }
+    } else {
+        // Terminated events are dropped without running
+        if (!ev->beginActivation(generation))
+            return;
+
+        ev->recordLateness(now());
+        ev->execute();
+    }
+
+    // A suspended body waits in the timer queue like any other activation, without holding the worker
+    if (ev->isSuspended()) {
+        arm(ev, now() + ev->getResumeDelay(), generation);
+        return;
+    }
+
+    // Periodic re-activation at the next absolute deadline
+    if (ev->endActivation(generation)) {
+        arm(ev, ev->nextDeadline(now()), generation);
+    } else {
+        retire();
+    }
+}
+
+void Scheduler::runVirtual() {
+    std::unique_lock<std::mutex> lock(timersMutex);
+
+    while (!stopping && !timers.empty()) {
+        TimerEntry next = timers.top();
+
+        // Activations past the horizon are left pending, as if the program was stopped
+        if (next.due - epoch > horizon)
+            break;
+
+        timers.pop();
+        if (next.generation != next.event->getArmGeneration())
+            continue;
+        lock.unlock();
+
+        // The clock jumps to the deadline, the body runs without waiting
+        virtualNow = std::max(virtualNow, next.due);
+        runActivation(next.event, next.generation);
+
+        lock.lock();
+    }
+}
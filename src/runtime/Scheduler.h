@@ -0,0 +1,286 @@
+/**
+ * @file Scheduler.h
+ * @brief Contains the definition of the runtime event scheduler.
+ *
+ * All the scheduled events share a single timer queue (a min-heap ordered by due time)
+ * and a fixed-size pool of worker threads that execute the event activations.
+ * Near deadlines are waited with `clock_nanosleep` on the absolute time, optionally
+ * spinning the last microseconds, so periods below one millisecond keep their phase.
+ *
+ * A event with slack may run anywhere between its due time and the end of its slack.
+ * The queue is ordered by that latest time, and each wake up of the timer thread takes
+ * every event that is already due, so the nearby deadlines share a single wake up.
+ *
+ * With phase staggering the periodic events that share a period get their first
+ * activation at spread offsets of it (0, 1/2, 1/4, 3/4, ...), measured from the start
+ * of the program, so their activations do not pile up at the same instants.
+ *
+ * When every worker is busy the due events wait in a ready queue ordered by the
+ * dispatch policy: fixed priority (the default) or earliest deadline first.
+ *
+ * With a virtual clock no threads are started: the thread that waits for the events
+ * runs every activation in due time order, jumping the clock to each deadline.
+ *
+ * @author Adrián Zamora Sánchez
+ * @see Event.h
+ * @see Runtime.h
+ */
+
+#pragma once
+#include "Event.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/// Order of the due events waiting for a worker.
+enum class Dispatch {
+    PRIORITY, ///< Highest priority first, ties in due time order
+    EDF       ///< Earliest absolute deadline first, the deadline of a periodic event is the end of its period
+};
+
+/// Counters of the timer thread, a snapshot readable from any thread.
+struct TimerStats {
+    std::uint64_t wakeups = 0;             ///< Wake ups of the timer thread that dispatched some activation
+    std::uint64_t activations = 0;         ///< Activations dispatched by the timer thread
+    std::uint64_t coalesced = 0;           ///< Activations dispatched before the end of their slack, in a shared wake up
+    std::chrono::nanoseconds slackUsed{0}; ///< Total delay after the due time of the activations with slack
+};
+
+/// Timer queue and worker pool shared by all the events of the program.
+class Scheduler {
+  public:
+    using Clock = Event::Clock;
+
+  private:
+    /// Pending activation of a event.
+    struct TimerEntry {
+        Clock::time_point latest; ///< End of the slack, the activation must be dispatched by then
+        Clock::time_point due;    ///< Time of the activation
+        std::uint64_t seq;        ///< Arm order, breaks the ties between equal times
+        Event *event;             ///< Event to activate, owned by the registry
+        std::uint32_t generation; ///< Arm generation of the event, the entry is stale once it changes
+
+        /// Reverse order for the min-heap.
+        bool operator>(const TimerEntry &other) const {
+            return latest > other.latest || (latest == other.latest && seq > other.seq);
+        }
+    };
+
+    std::priority_queue<TimerEntry, std::vector<TimerEntry>, std::greater<TimerEntry>> timers; ///< Timer queue
+    std::mutex timersMutex;                                                                     ///< Timer queue mutex
+    std::condition_variable timersCv; ///< Wakes up the timer thread
+    std::uint64_t armCount = 0;       ///< Entries pushed to the timer queue
+
+    // timer thread counters, only written by the timer thread
+    std::atomic<std::uint64_t> timerWakeups{0};     ///< Wake ups that dispatched some activation
+    std::atomic<std::uint64_t> timerActivations{0}; ///< Activations dispatched
+    std::atomic<std::uint64_t> coalesced{0};        ///< Activations dispatched before their latest time
+    std::atomic<std::int64_t> slackUsedNs{0};       ///< Delay after the due time of the activations with slack
+
+    /// Due activation waiting for a worker.
+    struct ReadyEntry {
+        Clock::time_point deadline; ///< Time the activation should be finished by
+        int priority;               ///< Priority of the event
+        std::uint64_t seq;          ///< Arm order of the activation
+        Event *event;               ///< Event to execute
+        std::uint32_t generation;   ///< Arm generation of the timer entry
+    };
+
+    std::vector<ReadyEntry> ready;   ///< Heap of the events due for execution, ordered by the dispatch policy
+    std::mutex readyMutex;           ///< Ready queue mutex
+    std::condition_variable readyCv; ///< Wakes up the workers
+    Dispatch dispatch;               ///< Order of the ready queue
+
+    /// Deadlines closer than this are slept with `clock_nanosleep` instead of the condition variable.
+    static constexpr Clock::duration PRECISE_WINDOW = std::chrono::microseconds(500);
+
+    Clock::time_point epoch;          ///< Creation time, origin of the `at` events
+    Clock::duration spin;             ///< Time spent spinning before each deadline
+    bool virtualTime = false;         ///< Activations run in the waiting thread at simulated times
+    Clock::time_point virtualNow;     ///< Simulated current time
+    Clock::duration horizon;          ///< Simulated time after which the pending activations are dropped
+    unsigned workerCount;             ///< Size of the worker pool
+    std::thread timerThread;          ///< Thread that waits for the next due time
+    std::vector<std::thread> workers; ///< Worker pool
+    std::once_flag startFlag;         ///< Lazy start of the threads
+    bool stopping = false;            ///< Stop flag, protected by both queue mutexes
+
+    // phase staggering, the periodic events with the same period are spread over it
+    bool stagger = false;                                       ///< Phases assigned at the schedule calls
+    std::unordered_map<std::int64_t, std::uint32_t> phaseSlots; ///< Phases already assigned per period in us
+    std::mutex phaseMutex;                                      ///< Phase slots mutex
+
+    int liveEvents = 0;             ///< Events armed or executing
+    std::mutex liveMutex;           ///< Live event counter mutex
+    std::condition_variable liveCv; ///< Signals when the last live event finishes
+
+    /// Timer thread loop, moves the due events to the ready queue.
+    void timerLoop();
+
+    /**
+     * @brief Ready queue order.
+     * @return `true` if the activation `a` runs after `b` with the dispatch policy.
+     */
+    bool runsAfter(const ReadyEntry &a, const ReadyEntry &b) const;
+
+    /**
+     * @brief Sleeps the calling thread until a absolute time, spinning the last `spin` of it.
+     * @param due Wake up time.
+     */
+    void sleepUntil(Clock::time_point due) const;
+
+    /// Worker thread loop, executes the ready events.
+    void workerLoop();
+
+    /**
+     * @brief Executes a activation of a event and arms the next one.
+     * @param ev Due event.
+     * @param generation Arm generation of its timer entry, a stale entry is dropped.
+     */
+    void runActivation(Event *ev, std::uint32_t generation);
+
+    /// Runs the activations in due time order on the calling thread, until none is left or the horizon is reached.
+    void runVirtual();
+
+    /**
+     * @brief Current time, real or simulated.
+     * @return Time used for the deadlines.
+     */
+    Clock::time_point now() const { return virtualTime ? virtualNow : Clock::now(); }
+
+    /// Decrements the live event counter, waking up the waiters when it reaches zero.
+    void retire();
+
+    /**
+     * @brief Delay of the first activation of a event that is being started.
+     * @param ev Periodic event, the other kinds and the aligned events are never delayed.
+     * @param now Time of the schedule call.
+     * @return Time until the next instant of the phase assigned to the event, zero without staggering.
+     */
+    Clock::duration phaseOf(Event *ev, Clock::time_point now);
+
+    /**
+     * @brief Timer queue entry of a activation, called with the timer queue locked.
+     * @param ev Event to activate.
+     * @param due Time of the activation.
+     * @param generation Arm generation of the timer chain of the event.
+     * @return Entry with the slack of the event applied, the virtual clock ignores it.
+     */
+    TimerEntry makeEntry(Event *ev, Clock::time_point due, std::uint32_t generation) {
+        Clock::duration slack = virtualTime ? Clock::duration::zero() : Clock::duration(ev->getSlack());
+        return {due + slack, due, armCount++, ev, generation};
+    }
+
+  public:
+    /**
+     * @brief Scheduler constructor.
+     * @param workers Number of worker threads, if set to 0 the number of cores is used.
+     * @param spin Time the timer thread spins before each deadline instead of sleeping.
+     * @param dispatch Order of the due events when every worker is busy.
+     */
+    explicit Scheduler(unsigned workers = 0,
+                       Clock::duration spin = Clock::duration::zero(),
+                       Dispatch dispatch = Dispatch::PRIORITY);
+
+    /// Scheduler destructor, stops and joins all the threads.
+    ~Scheduler();
+
+    /// Starts the timer and worker threads, only the first call has effect.
+    void start();
+
+    /**
+     * @brief Switches to the virtual clock, must be called before any event is activated.
+     * @param limit Simulated time to run, measured from the creation of the scheduler.
+     */
+    void useVirtualTime(Clock::duration limit);
+
+    /// Enables the phase staggering, must be called before any event is activated.
+    void enableStagger() { stagger = true; }
+
+    /// Stops the threads, pending activations are discarded.
+    void stop();
+
+    /**
+     * @brief Adds a event activation to the timer queue.
+     * @param ev Event to activate.
+     * @param due Time of the activation.
+     * @param generation Arm generation returned when the event was started or re-armed.
+     */
+    void arm(Event *ev, Clock::time_point due, std::uint32_t generation);
+
+    /**
+     * @brief Starts a event, its first activation is due immediately (`after` and `at` events wait for their time).
+     * @param ev Event to start, ignored if it is already running.
+     */
+    void activate(Event *ev);
+
+    /**
+     * @brief Starts a batch of events taking the queue locks once.
+     * @param batch Events to start, the ones already running are removed from it.
+     */
+    void activate(std::vector<Event *> &batch);
+
+    /**
+     * @brief Stops a event, a activation in progress is allowed to finish.
+     * @param ev Event to stop.
+     */
+    void cancel(Event &ev);
+
+    /// Blocks the calling thread until there are no events armed or executing, with a virtual clock it runs them.
+    void waitIdle();
+
+    /**
+     * @brief Checks if the calling thread may wait for a activation, like a producer of a full queue.
+     * @return `false` in the workers and with the virtual clock, the activation would never run.
+     */
+    bool mayBlock() const;
+
+    /**
+     * @brief Getter for the timer counters.
+     * @return Snapshot of the counters of the timer thread.
+     */
+    TimerStats getTimerStats() const;
+
+    /**
+     * @brief Getter for the worker count.
+     * @return Number of worker threads.
+     */
+    unsigned getWorkerCount() const { return workerCount; }
+
+    /**
+     * @brief Reads the worker count from the `T_WORKERS` environment variable.
+     * @return Number of workers, or the number of cores if the variable is not set.
+     */
+    static unsigned workerCountFromEnv();
+
+    /**
+     * @brief Reads the spin time from the `T_SPIN` environment variable, in microseconds.
+     * @return Spin time, zero if the variable is not set.
+     */
+    static Clock::duration spinFromEnv();
+
+    /**
+     * @brief Reads the virtual clock settings, `T_VIRTUAL` and `T_VIRTUAL_HORIZON` (seconds).
+     * @param limit Set to the simulated time to run, unlimited if the horizon is not set.
+     * @return `true` if the virtual clock is enabled.
+     */
+    static bool virtualTimeFromEnv(Clock::duration &limit);
+
+    /**
+     * @brief Reads the phase staggering switch from the `T_STAGGER` environment variable.
+     * @return `true` if the variable is set to a value other than 0.
+     */
+    static bool staggerFromEnv();
+
+    /**
+     * @brief Reads the dispatch policy from the `T_DISPATCH` environment variable (`priority` or `edf`).
+     * @return Dispatch policy, fixed priority if the variable is not set.
+     */
+    static Dispatch dispatchFromEnv();
+};
@@ -0,0 +1,143 @@
+#include "StringArena.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <unordered_set>
+
+/// Arena that replaces the thread arena, set while a coroutine event runs.
+static thread_local StringArena *activeArena = nullptr;
+
+/// Heap copies made by keep(), any thread may replace or adopt them.
+struct KeptStrings {
+    std::mutex mutex;                       ///< Taken by each store through a reference
+    std::unordered_set<const char *> owned; ///< Copies still referenced by a variable
+};
+
+/**
+ * @brief Getter for the heap copies, never destroyed so the runtime threads can use it until the exit.
+ * @return Copies shared by all the threads.
+ */
+static KeptStrings &keptStrings() {
+    static KeptStrings *kept = new KeptStrings;
+    return *kept;
+}
+
+StringArena &StringArena::local() {
+    thread_local StringArena arena;
+    return activeArena ? *activeArena : arena;
+}
+
+StringArena *StringArena::use(StringArena *arena) {
+    StringArena *previous = activeArena;
+    activeArena = arena;
+    return previous;
+}
+
+char *StringArena::allocate(std::size_t bytes) {
+    // The next chunk with enough room, a new one at the end if none of the retained chunks fits
+    while (current < chunks.size() && used + bytes > chunks[current].size) {
+        ++current;
+        used = 0;
+    }
+
+    if (current == chunks.size()) {
+        std::size_t size = std::max(chunkSize, bytes);
+        chunks.push_back({std::make_unique<char[]>(size), size});
+        used = 0;
+    }
+
+    char *ptr = chunks[current].data.get() + used;
+    used += bytes;
+    return ptr;
+}
+
+void StringArena::release(Mark mark) {
+    current = static_cast<std::size_t>(mark >> 32);
+    used = static_cast<std::size_t>(mark & 0xffffffff);
+}
+
+TString StringArena::releaseKeeping(Mark mark, TString value) {
+    if (!value.data || !inRegion(mark, value.data)) {
+        release(mark);
+        return value;
+    }
+
+    // The copy starts at or before the string when they share a chunk, memmove handles the overlap
+    std::size_t bytes = static_cast<std::size_t>(value.length) + 1;
+    release(mark);
+    char *kept = allocate(bytes);
+    std::memmove(kept, value.data, bytes);
+    return {kept, value.length};
+}
+
+void StringArena::releaseKeeping(Mark mark, TString *const *values, std::size_t count) {
+    // The copies may overwrite the kept bytes, they are saved first
+    static thread_local std::vector<char> saved;
+    static thread_local std::vector<std::size_t> moved;
+    saved.clear();
+    moved.clear();
+    for (std::size_t i = 0; i < count; ++i) {
+        const TString &value = *values[i];
+        if (value.data && inRegion(mark, value.data)) {
+            saved.insert(saved.end(), value.data, value.data + value.length + 1);
+            moved.push_back(i);
+        }
+    }
+
+    release(mark);
+    const char *next = saved.data();
+    for (std::size_t i : moved) {
+        std::size_t bytes = static_cast<std::size_t>(values[i]->length) + 1;
+        char *kept = allocate(bytes);
+        std::memcpy(kept, next, bytes);
+        values[i]->data = kept;
+        next += bytes;
+    }
+}
+
+bool StringArena::inRegion(Mark mark, const void *ptr) const {
+    std::size_t first = static_cast<std::size_t>(mark >> 32);
+    std::size_t offset = static_cast<std::size_t>(mark & 0xffffffff);
+    const char *p = static_cast<const char *>(ptr);
+
+    for (std::size_t i = first; i < chunks.size() && i <= current; ++i) {
+        const char *begin = chunks[i].data.get() + (i == first ? offset : 0);
+        if (p >= begin && p < chunks[i].data.get() + chunks[i].size)
+            return true;
+    }
+
+    return false;
+}
+
+void StringArena::keep(TString *target, TString value) {
+    // Copied before the previous value is freed, it may be the same string
+    if (value.data) {
+        std::size_t bytes = static_cast<std::size_t>(value.length) + 1;
+        char *copy = static_cast<char *>(std::malloc(bytes));
+        std::memcpy(copy, value.data, bytes);
+        value.data = copy;
+    }
+
+    // Only the copies made here are freed, the variable may hold a literal or a string of a region
+    KeptStrings &kept = keptStrings();
+    std::lock_guard<std::mutex> lock(kept.mutex);
+    if (target->data && kept.owned.erase(target->data))
+        std::free(const_cast<char *>(target->data));
+    if (value.data)
+        kept.owned.insert(value.data);
+    *target = value;
+}
+
+void StringArena::adopt(TString *target) {
+    KeptStrings &kept = keptStrings();
+    std::lock_guard<std::mutex> lock(kept.mutex);
+    if (!target->data || !kept.owned.erase(target->data))
+        return;
+
+    std::size_t bytes = static_cast<std::size_t>(target->length) + 1;
+    char *moved = local().allocate(bytes);
+    std::memcpy(moved, target->data, bytes);
+    std::free(const_cast<char *>(target->data));
+    target->data = moved;
+}
@@ -0,0 +1,121 @@
+/**
+ * @file StringArena.h
+ * @brief Contains the definition of the region allocator of the runtime strings.
+ *
+ * The strings returned by the runtime (`intToString`, `floatToString`) are bump
+ * allocated in a arena of the calling thread. The arena is used as a stack of
+ * regions: a event activation, a function frame or a loop iteration takes a mark when it
+ * starts and releases everything allocated after it when it ends. The chunks are kept for the
+ * next regions, so a long running program reaches a flat memory use.
+ *
+ * A suspended coroutine event can resume in another thread, so its strings are kept
+ * in a arena of the event that replaces the one of the thread while its body runs.
+ *
+ * @author Adrián Zamora Sánchez
+ * @see Event.h
+ */
+
+#pragma once
+#include "TString.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/// Stack of string regions of a single thread.
+class StringArena {
+    static constexpr std::size_t CHUNK_SIZE = 64 * 1024; ///< Bytes of a regular chunk
+
+    /// Memory block, never freed until the thread ends.
+    struct Chunk {
+        std::unique_ptr<char[]> data; ///< Chunk memory
+        std::size_t size;             ///< Bytes of the chunk, larger than chunkSize for long strings
+    };
+
+    std::vector<Chunk> chunks; ///< Chunks in allocation order
+    std::size_t current = 0;   ///< Chunk being filled
+    std::size_t used = 0;      ///< Bytes used in the current chunk
+    std::size_t chunkSize;     ///< Bytes of a regular chunk of this arena
+
+  public:
+    /// Position in the arena, `(chunk << 32) | used`.
+    using Mark = std::uint64_t;
+
+    /**
+     * @brief StringArena constructor, no memory is allocated until the first string.
+     * @param chunkSize Bytes of each chunk, smaller for the arenas of the events.
+     */
+    explicit StringArena(std::size_t chunkSize = CHUNK_SIZE) : chunkSize(chunkSize) {}
+
+    /**
+     * @brief Getter for the arena in use by the calling thread.
+     * @return Arena set with use(), or the thread arena.
+     */
+    static StringArena &local();
+
+    /**
+     * @brief Replaces the arena of the calling thread.
+     * @param arena Arena for the next strings, nullptr goes back to the thread arena.
+     * @return Arena replaced, nullptr if it was the thread arena.
+     */
+    static StringArena *use(StringArena *arena);
+
+    /**
+     * @brief Allocates memory in the innermost region.
+     * @param bytes Size of the allocation.
+     * @return Memory valid until the region is released.
+     */
+    char *allocate(std::size_t bytes);
+
+    /**
+     * @brief Starts a region.
+     * @return Mark to release the region.
+     */
+    Mark mark() const { return (static_cast<Mark>(current) << 32) | used; }
+
+    /**
+     * @brief Releases everything allocated after a mark.
+     * @param mark Mark taken at the start of the region.
+     */
+    void release(Mark mark);
+
+    /**
+     * @brief Releases a region keeping one of its strings, which is moved to the enclosing region.
+     * @param mark Mark taken at the start of the region.
+     * @param value String to keep, returned as is if it was not allocated in the region.
+     * @return The kept string.
+     */
+    TString releaseKeeping(Mark mark, TString value);
+
+    /**
+     * @brief Releases a region keeping the strings of some variables, which are copied to its start.
+     *
+     * The region stays open with the kept strings, so a loop releases it again in the next iteration.
+     *
+     * @param mark Mark taken at the start of the region.
+     * @param values Variables to keep, the ones that are not allocated in the region are not changed.
+     * @param count Number of variables.
+     */
+    void releaseKeeping(Mark mark, TString *const *values, std::size_t count);
+
+    /**
+     * @brief Checks if a pointer was allocated in this arena after a mark.
+     * @param mark Start of the region.
+     * @param ptr Pointer to check.
+     * @return `true` if the memory belongs to the region.
+     */
+    bool inRegion(Mark mark, const void *ptr) const;
+
+    /**
+     * @brief Stores a heap copy of a string that outlives its region, freeing the copy it replaces.
+     * @param target String variable that keeps the value.
+     * @param value String to keep.
+     */
+    static void keep(TString *target, TString value);
+
+    /**
+     * @brief Moves a string stored with keep() to the innermost region of the calling thread.
+     * @param target String variable, unchanged if its value is not a heap copy.
+     */
+    static void adopt(TString *target);
+};
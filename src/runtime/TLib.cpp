@@ -1,54 +1,113 @@
+#include "Output.h"
 #include "Runtime.h"
+#include "StringArena.h"
+#include <algorithm>
 #include <cstdarg>
 #include <cstdlib>
+#include <cstring>
 #include <stdio.h>
 #include <stdlib.h>
 
 /**
  * @brief Transforms a int to its string value.
  * @param x Int to convert
- * @return string buffer
+ * @return string buffer, valid until the region of the caller is released
  */
-extern "C" char *intToString(int x) {
-    char *buf = (char *)malloc(12);
-    if (!buf)
-        return nullptr;
+extern "C" TString intToString(int x) {
+    char *buf = StringArena::local().allocate(12);
 
-    sprintf(buf, "%d", x);
-    return buf;
+    int length = snprintf(buf, 12, "%d", x);
+    return {buf, length};
 }
 
 /**
  * @brief Transforms a float to its string value.
  * @param x Float to convert
- * @return string buffer
+ * @return string buffer, valid until the region of the caller is released
  */
-extern "C" char *floatToString(float x) {
-    char *buf = (char *)malloc(32);
-    if (!buf)
-        return nullptr;
+extern "C" TString floatToString(float x) {
+    char *buf = StringArena::local().allocate(48);
 
-    snprintf(buf, 32, "%f", (double)x);
-    return buf;
+    // A value too long for the buffer is truncated, the length is the one actually written
+    int length = snprintf(buf, 48, "%f", (double)x);
+    return {buf, std::min(length, 47)};
 }
 
 /**
- * @brief Prints the parameters to the std out.
- * @param first At least the first string to print.
- * @param ... More string parameters to print, might be none.
+ * @brief Prints the parameters to the std out as a single line, buffered by the calling thread.
+ * @param count Number of strings to print.
+ * @param ... Bytes and length of each string.
  */
-extern "C" void print(const char *first, ...) {
+extern "C" void print(int count, ...) {
     va_list args;
-    va_start(args, first);
+    va_start(args, count);
 
-    const char *s = first;
+    Output::printLine(count, args);
 
-    while (s != NULL) {
-        fputs(s, stdout);
-        s = va_arg(args, const char *);
-    }
+    va_end(args);
+}
+
+/**
+ * @brief Starts a string region of the calling thread, at the entry of a function frame, a loop or a statement.
+ * @return Mark of the region.
+ */
+extern "C" std::uint64_t enterStringScope() {
+    return StringArena::local().mark();
+}
+
+/**
+ * @brief Releases the strings created since the region started.
+ * @param mark Mark returned by enterStringScope.
+ */
+extern "C" void leaveStringScope(std::uint64_t mark) {
+    StringArena::local().release(mark);
+}
+
+/**
+ * @brief Releases a region keeping the returned string, which is moved to the region of the caller.
+ * @param mark Mark returned by enterStringScope.
+ * @param data Bytes of the string returned by the function.
+ * @param length Length of the string.
+ * @return String valid in the region of the caller.
+ */
+extern "C" TString leaveStringScopeKeeping(std::uint64_t mark, const char *data, std::int64_t length) {
+    return StringArena::local().releaseKeeping(mark, {data, length});
+}
 
-    fputc('\n', stdout);
-    fflush(stdout);
+/**
+ * @brief Releases a loop region keeping the strings of the variables declared outside of the loop.
+ * @param mark Mark returned by enterStringScope.
+ * @param count Number of variables.
+ * @param ... Pointers to the string variables.
+ */
+extern "C" void leaveStringScopeKeepingVars(std::uint64_t mark, std::int32_t count, ...) {
+    static thread_local std::vector<TString *> values;
+    values.clear();
+
+    va_list args;
+    va_start(args, count);
+    for (std::int32_t i = 0; i < count; ++i) {
+        values.push_back(va_arg(args, TString *));
+    }
     va_end(args);
-}
\ No newline at end of file
+
+    StringArena::local().releaseKeeping(mark, values.data(), values.size());
+}
+
+/**
+ * @brief Stores a string through a reference, copied to the heap instead of the region of the callee.
+ * @param target String variable of the caller.
+ * @param data Bytes of the string to keep.
+ * @param length Length of the string.
+ */
+extern "C" void storeRefString(TString *target, const char *data, std::int64_t length) {
+    StringArena::keep(target, {data, length});
+}
+
+/**
+ * @brief Moves a string stored through a reference to the region of the caller once the call returns.
+ * @param target String variable of the caller.
+ */
+extern "C" void adoptRefString(TString *target) {
+    StringArena::adopt(target);
+}
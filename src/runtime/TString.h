@@ -0,0 +1,22 @@
+/**
+ * @file TString.h
+ * @brief Contains the definition of the string values shared by the compiled code and the runtime.
+ *
+ * A string is a `{ptr, len}` pair (`%TString` in the IR), so its length is never
+ * computed again from the bytes. The bytes are always followed by a null terminator.
+ * Two integer words are returned in registers by the x86-64 calling convention, the
+ * same as the IR struct, but the runtime functions receive its fields as separate
+ * parameters.
+ *
+ * @author Adrián Zamora Sánchez
+ * @see StringArena.h
+ */
+
+#pragma once
+#include <cstdint>
+
+/// String value of the compiled programs.
+struct TString {
+    const char *data;    ///< Bytes of the string, null terminated
+    std::int64_t length; ///< Number of bytes, without the terminator
+};
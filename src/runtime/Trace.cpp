@@ -0,0 +1,97 @@
+#include "Trace.h"
+#include "spdlog/spdlog.h"
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+bool Trace::enabled = false;
+
+Trace::State &Trace::state() {
+    static State instance;
+    return instance;
+}
+
+bool Trace::startFromEnv() {
+    const char *env = std::getenv("T_TRACE");
+    if (!env || !*env)
+        return false;
+
+    state().path = env;
+    state().epoch = Clock::now();
+    enabled = true;
+    return true;
+}
+
+Trace::ThreadBuffer &Trace::threadBuffer() {
+    thread_local ThreadBuffer *buffer = nullptr;
+
+    if (!buffer) {
+        auto created = std::make_unique<ThreadBuffer>();
+        created->tid = syscall(SYS_gettid);
+        buffer = created.get();
+
+        std::lock_guard<std::mutex> lock(state().buffersMutex);
+        state().buffers.push_back(std::move(created));
+    }
+
+    return *buffer;
+}
+
+void Trace::record(const char *name,
+                   Clock::time_point begin,
+                   Clock::time_point end,
+                   std::chrono::nanoseconds lateness) {
+    ThreadBuffer &buffer = threadBuffer();
+
+    // A new chunk when the current one is full, the previous records never move
+    if (buffer.used == CHUNK_SIZE) {
+        buffer.chunks.push_back(std::make_unique<Record[]>(CHUNK_SIZE));
+        buffer.used = 0;
+    }
+
+    Clock::time_point epoch = state().epoch;
+    buffer.chunks.back()[buffer.used++] = {name, std::chrono::nanoseconds(begin - epoch).count(),
+                                           std::chrono::nanoseconds(end - epoch).count(), lateness};
+}
+
+void Trace::write() {
+    if (!enabled)
+        return;
+
+    // Written at exit, after the spdlog registry may have been destroyed
+    State &data = state();
+    std::ofstream out(data.path);
+    if (!out) {
+        std::cerr << "Can not open the trace file: " << data.path << "\n";
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(data.buffersMutex);
+    long pid = getpid();
+    bool first = true;
+
+    // Chrome trace format, complete events ("X") with the timestamps in microseconds
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (const auto &buffer : data.buffers) {
+        out << (first ? "\n" : ",\n") << fmt::format(R"({{"ph":"M","name":"thread_name","pid":{},"tid":{},)"
+                                                     R"("args":{{"name":"worker {}"}}}})",
+                                                     pid, buffer->tid, buffer->tid);
+        first = false;
+
+        for (std::size_t c = 0; c < buffer->chunks.size(); ++c) {
+            std::size_t count = c + 1 == buffer->chunks.size() ? buffer->used : CHUNK_SIZE;
+
+            for (std::size_t i = 0; i < count; ++i) {
+                const Record &r = buffer->chunks[c][i];
+                out << ",\n"
+                    << fmt::format(R"({{"ph":"X","name":"{}","cat":"event","pid":{},"tid":{},"ts":{:.3f},)"
+                                   R"("dur":{:.3f},"args":{{"lateness_us":{:.3f}}}}})",
+                                   r.name, pid, buffer->tid, r.begin / 1000.0, (r.end - r.begin) / 1000.0,
+                                   r.lateness.count() / 1000.0);
+            }
+        }
+    }
+    out << "\n]}\n";
+}
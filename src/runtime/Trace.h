@@ -0,0 +1,94 @@
+/**
+ * @file Trace.h
+ * @brief Contains the definition of the activation tracer.
+ *
+ * When the `T_TRACE=<file.json>` environment variable is set, every event activation
+ * is recorded with its begin and end time and its thread, and the timeline is written
+ * at exit in the Chrome trace format (loadable in Perfetto or chrome://tracing).
+ *
+ * @author Adrián Zamora Sánchez
+ * @see Event.h
+ * @see Runtime.h
+ */
+
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// Global activation tracer, each thread writes in its own buffer without locks.
+class Trace {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+  private:
+    /// Activation of a event.
+    struct Record {
+        const char *name;                  ///< Event ID, a constant of the compiled program
+        std::int64_t begin;                ///< Start of the body in ns since the trace start
+        std::int64_t end;                  ///< End of the body in ns since the trace start
+        std::chrono::nanoseconds lateness; ///< Start of the body - deadline
+    };
+
+    static constexpr std::size_t CHUNK_SIZE = 4096; ///< Records per allocation
+
+    /// Records of a single thread, only written by its owner.
+    struct ThreadBuffer {
+        long tid;                                      ///< Kernel thread ID
+        std::vector<std::unique_ptr<Record[]>> chunks; ///< Full and current chunks
+        std::size_t used = CHUNK_SIZE;                 ///< Records in the last chunk
+    };
+
+    /// Tracer data, a function static so it outlives the global runtime that writes it at exit.
+    struct State {
+        std::string path;                                   ///< Output file
+        Clock::time_point epoch;                            ///< Origin of the timestamps
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers; ///< Buffers of all the threads
+        std::mutex buffersMutex; ///< Only taken when a thread records for the first time and when writing
+    };
+
+    static bool enabled; ///< Set once at startup, before any event runs
+
+    /**
+     * @brief Getter for the tracer data.
+     * @return Data shared by all the threads.
+     */
+    static State &state();
+
+    /**
+     * @brief Buffer of the calling thread, created on its first record.
+     * @return Thread buffer.
+     */
+    static ThreadBuffer &threadBuffer();
+
+  public:
+    /**
+     * @brief Enables the tracer if the `T_TRACE` environment variable is set.
+     * @return `true` if the tracer is enabled.
+     */
+    static bool startFromEnv();
+
+    /**
+     * @brief Getter for the enabled flag.
+     * @return `true` if the activations must be recorded.
+     */
+    static bool isEnabled() { return enabled; }
+
+    /**
+     * @brief Records a activation in the buffer of the calling thread.
+     * @param name Event ID.
+     * @param begin Start of the body.
+     * @param end End of the body.
+     * @param lateness Start of the body - deadline.
+     */
+    static void record(const char *name,
+                       Clock::time_point begin,
+                       Clock::time_point end,
+                       std::chrono::nanoseconds lateness);
+
+    /// Writes the recorded activations, the event threads must be stopped before this call.
+    static void write();
+};
@@ -1,4 +1,6 @@
+#include "Realtime.h"
 #include "Runtime.h"
+#include <algorithm>
 #include <iostream>
 #include <stdio.h>
 #include <stdlib.h>
@@ -10,37 +12,180 @@ extern "C" Runtime *getRuntime() {
     return &GLOBAL_RUNTIME;
 }
 
-using EventFn = void (*)();
-
 /**
  * Function responsible of loading event data in the runtime.
  * @param id Identifier of the new Event.
- * @param period Time period of the new Event.
- * @param fnPtr Compilated event function name.
+ * @param period Time period of the new Event, in microseconds.
+ * @param thunk Compiled trampoline that unpacks argv and calls the event function.
  * @param argCount Number of parameters of the function signature.
  * @param argTypes Types of the function parameters.
  * @param limit Number of limit executions for this Event, if set to 0 it has no numeric limit.
+ * @param command Time command of the Event (0 `every`, 1 `at`, 2 `after`).
+ * @param overrun Overrun policy of the Event (0 skip, 1 catch up, 2 coalesce).
+ * @param priority Dispatch priority of the Event, higher values run first.
+ * @return Handle used by the generated code to refer to the new Event.
+ */
+extern "C" std::uint64_t registerEventData(const char *id,
+                                           std::int64_t period,
+                                           void (*thunk)(void **),
+                                           int argCount,
+                                           const int *argTypes,
+                                           int limit,
+                                           int command,
+                                           int overrun,
+                                           int priority) {
+    EventKind kind = EventKind::EVERY;
+    if (command == static_cast<int>(EventKind::AT) || command == static_cast<int>(EventKind::AFTER))
+        kind = static_cast<EventKind>(command);
+
+    Overrun policy = Overrun::SKIP;
+    if (overrun == static_cast<int>(Overrun::CATCH_UP) || overrun == static_cast<int>(Overrun::COALESCE))
+        policy = static_cast<Overrun>(overrun);
+
+    return getRuntime()->registerEvent(
+        id, std::chrono::microseconds(period), thunk, argCount, argTypes, limit, kind, policy, priority);
+}
+
+/**
+ * Function responsible of switching a event to queued mode.
+ * @param handle Handle of the event, right after its registration.
+ * @param capacity Maximum number of pending argument tuples.
+ * @param policy Full-queue policy (0 block, 1 drop oldest, 2 drop newest).
+ */
+extern "C" void configureEventQueue(std::uint64_t handle, int capacity, int policy) {
+    QueueFull full = QueueFull::BLOCK;
+    if (policy == static_cast<int>(QueueFull::DROP_OLDEST) || policy == static_cast<int>(QueueFull::DROP_NEWEST))
+        full = static_cast<QueueFull>(policy);
+
+    getRuntime()->setQueue(handle, static_cast<std::size_t>(std::max(1, capacity)), full);
+}
+
+/**
+ * Function responsible of setting the slack of a event, its activations may run up to this delay after their time.
+ * @param handle Handle of the event, right after its registration.
+ * @param slack Allowed delay, in microseconds.
  */
-extern "C" void
-registerEventData(const char *id, float period, void (*fnPtr)(), int argCount, const int *argTypes, int limit) {
-    getRuntime()->registerEvent(std::string(id), period, fnPtr, argCount, argTypes, limit);
+extern "C" void configureEventSlack(std::uint64_t handle, std::int64_t slack) {
+    getRuntime()->setSlack(handle, std::chrono::microseconds(slack));
+}
+
+/**
+ * Function responsible of excluding a event from the phase staggering, its activations keep the schedule call phase.
+ * @param handle Handle of the event, right after its registration.
+ */
+extern "C" void alignEventPhase(std::uint64_t handle) {
+    getRuntime()->setAligned(handle);
+}
+
+/// Static registration data of a event, emitted by the compiler in a constant table.
+struct EventDescriptor {
+    const char *id;             ///< Identifier of the Event
+    std::int64_t period;        ///< Time period, in microseconds
+    void (*thunk)(void **);     ///< Compiled trampoline of the event function
+    const int *argTypes;        ///< Types of the function parameters
+    std::uint64_t *handle;      ///< Global of the generated code that receives the handle
+    std::int32_t argCount;      ///< Number of parameters of the function signature
+    std::int32_t limit;         ///< Number of limit executions, 0 if it has no numeric limit
+    std::int32_t command;       ///< Time command (0 `every`, 1 `at`, 2 `after`)
+    std::int32_t overrun;       ///< Overrun policy (0 skip, 1 catch up, 2 coalesce)
+    std::int32_t priority;      ///< Dispatch priority
+    std::int32_t queueCapacity; ///< Maximum number of pending argument tuples, 0 if the Event is not queued
+    std::int32_t queueFull;     ///< Full-queue policy (0 block, 1 drop oldest, 2 drop newest)
+    std::int64_t slack;         ///< Delay allowed after each activation time, in microseconds
+    std::int32_t aligned;       ///< Non zero if the Event is never staggered
+};
+
+/**
+ * Function responsible of loading the events of the descriptor table, called once at the start of the program.
+ * Each descriptor is registered like a registerEventData call: the Event keeps pointers to its id and type
+ * codes, which live in the read-only data of the program, but builds its own argument offsets and slots.
+ * @param table Descriptors of the events with a constant period that are called by the program.
+ * @param count Number of descriptors.
+ */
+extern "C" void registerEventTable(const EventDescriptor *table, int count) {
+    for (int i = 0; i < count; ++i) {
+        const EventDescriptor &d = table[i];
+        *d.handle = registerEventData(
+            d.id, d.period, d.thunk, d.argCount, d.argTypes, d.limit, d.command, d.overrun, d.priority);
+
+        if (d.queueCapacity > 0)
+            configureEventQueue(*d.handle, d.queueCapacity, d.queueFull);
+        if (d.slack > 0)
+            configureEventSlack(*d.handle, d.slack);
+        if (d.aligned)
+            alignEventPhase(*d.handle);
+    }
+}
+
+/**
+ * Function responsible of loading the data of a `when` event in the runtime.
+ * @param id Identifier of the new Event.
+ * @param thunk Compiled trampoline that calls the event function.
+ * @return Handle used by the generated code to refer to the new Event.
+ */
+extern "C" std::uint64_t registerWhenEventData(const char *id, void (*thunk)(void **)) {
+    return getRuntime()->registerWhenEvent(id, thunk);
+}
+
+/**
+ * Function responsible of updating the condition of a `when` event.
+ * @param handle Handle of the event.
+ * @param value Non zero if the condition is true.
+ */
+extern "C" void updateEventCondition(std::uint64_t handle, int value) {
+    getRuntime()->updateCondition(handle, value != 0);
 }
 
 /**
  * Function responsible of executing a event in the runtime.
- * @param id Event id to execute.
+ * @param handle Handle of the event to execute.
  * @param argv Arguments for the event execution.
  */
-extern "C" void scheduleEventData(const char *id, void **argv) {
-    getRuntime()->scheduleEvent(std::string(id), argv);
+extern "C" void scheduleEventData(std::uint64_t handle, void **argv) {
+    getRuntime()->scheduleEvent(handle, argv);
+}
+
+/**
+ * Function responsible of adding a event to the batch of the calling thread, used by the calls inside loops.
+ * @param handle Handle of the event to execute.
+ * @param argv Arguments for the event execution, copied before returning.
+ */
+extern "C" void batchEventData(std::uint64_t handle, void **argv) {
+    getRuntime()->batchEvent(handle, argv);
+}
+
+/// Function responsible of activating the events batched by the calling thread, called at the end of the loops.
+extern "C" void flushEventBatch() {
+    getRuntime()->flushBatch();
+}
+
+/**
+ * Function responsible of suspending the coroutine event running in the calling thread, at a `wait` or `yield`.
+ * The batched activations are flushed first, the rest of the body may resume in another thread.
+ * @param frame Coroutine frame of the event.
+ * @param delay Time until the body is resumed, in microseconds (0 for `yield`).
+ */
+extern "C" void suspendEvent(void *frame, std::int64_t delay) {
+    getRuntime()->flushBatch();
+    Event::suspendCurrent(frame, std::chrono::microseconds(delay));
+}
+
+/// Function responsible of preparing the strings of a coroutine event, called at the start of its body.
+extern "C" void beginEventCoroutine() {
+    Event::useOwnStrings();
+}
+
+/// Function responsible of enabling the real-time mode, called first in programs compiled with `--realtime`.
+extern "C" void enableRealtime() {
+    Realtime::enable();
 }
 
 /**
  * Function responsible of stopping a event.
- * @param id Event id to terminate.
+ * @param handle Handle of the event to terminate.
  */
-extern "C" void exitEvent(const char *id) {
-    getRuntime()->terminateEvent(std::string(id));
+extern "C" void exitEvent(std::uint64_t handle) {
+    getRuntime()->terminateEvent(handle);
 }
 
 /// Main LLVM caller
@@ -50,14 +195,8 @@ int main(int argc, char **argv) {
     int ret = mainLLVM();
     spdlog::debug("0-1");
 
-    // If there are events running the main loop keeps active
-    while (true) {
-        if (GLOBAL_RUNTIME.getEventCount() <= 0) {
-            break;
-        } else {
-            GLOBAL_RUNTIME.checkEvents();
-        }
-    }
+    // If there are events running the main thread sleeps until the last one finishes
+    GLOBAL_RUNTIME.waitForEvents();
 
     return ret;
 }
\ No newline at end of file
@@ -58,6 +58,7 @@ class Symbol {
     Type type;
     SymbolCategory category;
     int numParams;
+    bool trigger = false;
 
   public:
     /**
@@ -122,6 +123,15 @@ class Symbol {
         numParams = params;
     }
 
+    /// Marks the variable as read by the condition of a `when` event, it gets static storage.
+    void setTrigger() { trigger = true; }
+
+    /**
+     * @brief Returns true if the condition of a `when` event reads this variable.
+     * @return `true` if the variable is a trigger, `false` otherwise.
+     */
+    bool isTrigger() const { return trigger; }
+
     /**
      * @brief Setter for llvmVal.
      * @param val New LLVM Value for this symbol.
@@ -47,6 +47,9 @@ void *SemanticVisitor::visit(TimeLiteralNode &node) {
     switch (node.getTimeStamp()) {
     case TimeStamp::TYPE_TICK:
         return nullptr;
+    case TimeStamp::TYPE_US:
+        node.setValue(time / 1000);
+        break;
     case TimeStamp::TYPE_SEC:
         node.setValue(time * 1000);
         break;
@@ -290,7 +293,11 @@ void *SemanticVisitor::visit(FunctionDefNode &node) {
         }
     }
 
+    // A function defined inside a event can not suspend it
+    EventNode *prevEvent = currentEvent;
+    currentEvent = nullptr;
     node.getCodeBlock()->accept(*this);
+    currentEvent = prevEvent;
 
     symtab.exitScope();
     return nullptr;
@@ -430,6 +437,30 @@ void *SemanticVisitor::visit(EventNode &node) {
             CompilerError(CompilerPhase::SEMANTIC, node.getSourceLocation(), node.getValue(), errorMsg));
     }
 
+    // Single activation timers run once per schedule call
+    if ((node.getTimeCommand() == TimeCommand::TIME_AT || node.getTimeCommand() == TimeCommand::TIME_AFTER) &&
+        node.getLimit() > 0) {
+        std::string errorMsg = "The event " + node.getValue() + " runs once per call with `" +
+                               timeCommandToString(node.getTimeCommand()) + "`, it can not have a limit.";
+        errorList.push_back(
+            CompilerError(CompilerPhase::SEMANTIC, node.getSourceLocation(), node.getValue(), errorMsg));
+    }
+
+    // Only periodic events can overrun their period
+    if (node.getTimeCommand() != TimeCommand::TIME_EVERY && node.getOverrunPolicy() != OverrunPolicy::OVERRUN_SKIP) {
+        std::string errorMsg = "The overrun policy " + overrunPolicyToString(node.getOverrunPolicy()) +
+                               " of the event " + node.getValue() + " can only be used with `every`.";
+        errorList.push_back(
+            CompilerError(CompilerPhase::SEMANTIC, node.getSourceLocation(), node.getValue(), errorMsg));
+    }
+
+    // Queued events consume one argument tuple per activation, only periodic events activate repeatedly
+    if (node.getQueueCapacity() > 0 && node.getTimeCommand() != TimeCommand::TIME_EVERY) {
+        std::string errorMsg = "The argument queue of the event " + node.getValue() + " can only be used with `every`.";
+        errorList.push_back(
+            CompilerError(CompilerPhase::SEMANTIC, node.getSourceLocation(), node.getValue(), errorMsg));
+    }
+
     std::shared_ptr<Scope> currentScope = symtab.getCurrentScope();
 
     // Inserts the event identifier in the current scope
@@ -437,8 +468,22 @@ void *SemanticVisitor::visit(EventNode &node) {
     newSymbol.setNumParams(node.getParamsCount());
     currentScope->insertSymbol(newSymbol);
 
-    // Check for the time stmt
-    node.getTimeStmt()->accept(*this);
+    if (node.getTimeCommand() == TimeCommand::TIME_WHEN) {
+        // The condition is checked in the scope of the definition, its variables are the event triggers
+        node.getCondition()->accept(*this);
+        std::size_t errorCount = errorList.size();
+        collectTriggers(node.getCondition(), node);
+
+        if (node.getTriggers().empty() && errorList.size() == errorCount) {
+            std::string errorMsg = "The condition of the event " + node.getValue() +
+                                   " does not read any variable, so it would never be evaluated again.";
+            errorList.push_back(
+                CompilerError(CompilerPhase::SEMANTIC, node.getSourceLocation(), node.getValue(), errorMsg));
+        }
+    } else {
+        // Check for the time stmt
+        node.getTimeStmt()->accept(*this);
+    }
 
     // Creates a new scope for this event
     std::shared_ptr<Scope> newScope = symtab.enterScope(false);
@@ -453,11 +498,63 @@ void *SemanticVisitor::visit(EventNode &node) {
         }
     }
 
+    EventNode *prevEvent = currentEvent;
+    currentEvent = &node;
     node.getCodeBlock()->accept(*this);
+    currentEvent = prevEvent;
 
     return nullptr;
 }
 
+void SemanticVisitor::collectTriggers(ASTNode *expr, EventNode &event) {
+    if (!expr)
+        return;
+
+    // Only the variables can change after the definition, a increment or decrement reads its variable too
+    std::string name;
+    if (auto var = dynamic_cast<VariableRefNode *>(expr)) {
+        name = var->getValue();
+    } else if (auto unary = dynamic_cast<UnaryOperationNode *>(expr)) {
+        name = unary->getValue();
+    }
+
+    if (!name.empty()) {
+        Symbol *symbol = symtab.getCurrentScope()->getSymbol(name);
+
+        // Scope of the declaration, it belongs to a frame if a function or event body encloses it
+        std::shared_ptr<Scope> scope = symtab.getCurrentScope();
+        while (scope && !scope->contains(name))
+            scope = scope->getParent();
+        bool local = false;
+        for (; scope && !local; scope = scope->getParent())
+            local = !scope->isBlock();
+
+        if (symbol && symbol->getCategory() == SymbolCategory::VARIABLE && local) {
+            // A trigger is a single variable shared by every activation, it can not follow a frame
+            std::string errorMsg = "The condition of the event " + event.getValue() + " can not read the variable " +
+                                   name + " of a function or event body, only the variables of the main program.";
+            errorList.push_back(
+                CompilerError(CompilerPhase::SEMANTIC, event.getSourceLocation(), event.getValue(), errorMsg));
+        } else if (symbol && symbol->getCategory() == SymbolCategory::VARIABLE) {
+            symbol->setTrigger();
+            event.addTrigger(name);
+        } else if (symbol && symbol->getCategory() == SymbolCategory::PARAMETER) {
+            // The condition is evaluated by its own function, outside of the frame of the parameter
+            std::string errorMsg = "The condition of the event " + event.getValue() + " can not read the parameter " +
+                                   name + ", only variables.";
+            errorList.push_back(
+                CompilerError(CompilerPhase::SEMANTIC, event.getSourceLocation(), event.getValue(), errorMsg));
+        }
+    } else if (auto binary = dynamic_cast<BinaryExprNode *>(expr)) {
+        collectTriggers(binary->getLeft(), event);
+        collectTriggers(binary->getRight(), event);
+    } else if (auto call = dynamic_cast<FunctionCallNode *>(expr)) {
+        for (int i = 0; i < call->getParamsCount(); i++) {
+            collectTriggers(call->getParam(i), event);
+        }
+    }
+}
+
 void *SemanticVisitor::visit(ExitNode &node) {
     if (!symtab.getCurrentScope()->getSymbol(node.getValue())) {
         std::string errorMsg = "The exit keyword can not find the event: " + node.getValue() + " as it does not exist";
@@ -470,4 +567,32 @@ void *SemanticVisitor::visit(ExitNode &node) {
             CompilerError(CompilerPhase::SEMANTIC, node.getSourceLocation(), node.getValue(), errorMsg));
     }
     return nullptr;
-};
\ No newline at end of file
+};
+
+void *SemanticVisitor::visit(SuspendNode &node) {
+    // Only a event activation can be suspended, its body is compiled as a coroutine
+    if (!currentEvent) {
+        std::string errorMsg = "The " + node.getValue() + " statement can only be used in the body of a event";
+        errorList.push_back(
+            CompilerError(CompilerPhase::SEMANTIC, node.getSourceLocation(), node.getValue(), errorMsg));
+        return nullptr;
+    }
+    currentEvent->setCoroutine();
+
+    if (!node.getTimeStmt())
+        return nullptr;
+
+    node.getTimeStmt()->accept(*this);
+
+    // The wait time must be a time value
+    if (auto var = dynamic_cast<VariableRefNode *>(node.getTimeStmt())) {
+        Symbol *symbol = symtab.getCurrentScope()->getSymbol(var->getValue());
+        if (symbol && symbol->getType() != SupportedTypes::TYPE_TIME) {
+            std::string errorMsg = "The wait time " + var->getValue() + " is not a time variable";
+            errorList.push_back(
+                CompilerError(CompilerPhase::SEMANTIC, node.getSourceLocation(), node.getValue(), errorMsg));
+        }
+    }
+
+    return nullptr;
+}
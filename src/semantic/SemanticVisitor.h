@@ -15,8 +15,16 @@
 class SemanticVisitor {
     SymbolTable &symtab;
     unsigned int loopDepth = 0;
+    EventNode *currentEvent = nullptr; // Event whose body is being visited, its suspend points make it a coroutine
     std::vector<CompilerError> &errorList;
 
+    /**
+     * @brief Registers the variables read by the condition of a `when` event as its triggers.
+     * @param expr Condition expression (or sub-expression).
+     * @param event Event activated by the condition.
+     */
+    void collectTriggers(ASTNode *expr, EventNode &event);
+
   public:
     /**
      * @brief Default SemanticVisitor constructor.
@@ -138,6 +146,12 @@ class SemanticVisitor {
      */
     void *visit(ExitNode &node);
 
+    /**
+     * @brief Visits a `wait` or `yield` statement node.
+     * @param node Node to be visited.
+     */
+    void *visit(SuspendNode &node);
+
     /// Prints the content of the SymbolTable.
     void printSymbolTable() const { symtab.print(); }
 };
\ No newline at end of file
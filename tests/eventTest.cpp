@@ -6,7 +6,7 @@ TEST(eventTest, eventEvery) {
     /* Expected IR */
     std::vector<std::string> regexpr;
     regexpr.push_back(R"(define void @test)");
-    regexpr.push_back(R"(call void @registerEventData)");
+    regexpr.push_back(R"(call i64 @registerEventData)");
     regexpr.push_back(R"(ptr @str)");
     regexpr.push_back(R"(float 2.)");
     regexpr.push_back(R"(ptr @test)");
@@ -15,6 +15,207 @@ TEST(eventTest, eventEvery) {
     test(fileName, regexpr);
 }
 
+TEST(eventTest, eventThunk) {
+    const std::string fileName = std::string(TEST_FILES_DIR) + "eventEvery.T";
+
+    /* Expected IR */
+    std::vector<std::string> regexpr;
+    regexpr.push_back(R"(define internal void @test_thunk\(ptr %argv\))");
+    regexpr.push_back(R"(load i32, ptr)");
+    regexpr.push_back(R"(call void @test\(i32 %arg\))");
+    regexpr.push_back(R"(ptr @test_thunk)");
+
+    test(fileName, regexpr);
+}
+
+TEST(eventTest, eventHandle) {
+    const std::string fileName = std::string(TEST_FILES_DIR) + "eventEvery.T";
+
+    /* Expected IR */
+    std::vector<std::string> regexpr;
+    regexpr.push_back(R"(@test_handle = internal global i64 0)");
+    regexpr.push_back(R"(%event_handle = call i64 @registerEventData)");
+    regexpr.push_back(R"(store i64 %event_handle, ptr @test_handle)");
+    regexpr.push_back(R"(load i64, ptr @test_handle)");
+    regexpr.push_back(R"(call void @scheduleEventData\(i64 %event_handle)");
+
+    test(fileName, regexpr);
+}
+
+TEST(eventTest, eventWhen) {
+    const std::string fileName = std::string(TEST_FILES_DIR) + "eventWhen.T";
+
+    /* Expected IR */
+    std::vector<std::string> regexpr;
+    regexpr.push_back(R"(define void @alarm\(\))");
+    regexpr.push_back(R"(call i64 @registerWhenEventData\(ptr @event_id, ptr @alarm_thunk\))");
+    regexpr.push_back(R"(@x_ptr = internal global i32 0)");
+    regexpr.push_back(R"(call void @alarm_when\(\))");
+    regexpr.push_back(R"(store i32 3, ptr @x_ptr)");
+    regexpr.push_back(R"(call void @x_changed\(\))");
+    regexpr.push_back(R"(define internal void @alarm_when\(\))");
+    regexpr.push_back(R"(icmp sgt i32 %x_val)");
+    regexpr.push_back(R"(call void @updateEventCondition\(i64 %event_handle)");
+
+    test(fileName, regexpr);
+}
+
+TEST(eventTest, eventWhenRef) {
+    const std::string fileName = std::string(TEST_FILES_DIR) + "eventWhenRef.T";
+
+    /* Expected IR */
+    std::vector<std::string> regexpr;
+    regexpr.push_back(R"(@count_ptr = internal global i32 0)");
+    regexpr.push_back(R"(call i32 @bump\(ptr @count_ptr\))");
+    regexpr.push_back(R"(store i32 5, ptr %x)");
+    regexpr.push_back(R"(call void @ref_changed\(\))");
+    regexpr.push_back(R"(define internal void @ref_changed\(\)[[:space:]]*\{[[:space:]]*entry:[[:space:]]*call void @full_when\(\))");
+    regexpr.push_back(R"(load i32, ptr @count_ptr)");
+
+    test(fileName, regexpr);
+}
+
+TEST(eventTest, eventAfter) {
+    const std::string fileName = std::string(TEST_FILES_DIR) + "eventAfter.T";
+
+    /* Expected IR */
+    std::vector<std::string> regexpr;
+    regexpr.push_back(R"(define void @reminder\(i32 %x\))");
+    regexpr.push_back(R"(%EventDescriptor \{ ptr @event_id, i64 1500000, ptr @reminder_thunk, ptr @reminder_argtypes, ptr @reminder_handle, i32 1, i32 0, i32 2, i32 0, i32 0, i32 0, i32 0, i64 0, i32 0 \})");
+    regexpr.push_back(R"(call void @scheduleEventData\(i64 %event_handle)");
+
+    test(fileName, regexpr);
+}
+
+TEST(eventTest, eventOverrun) {
+    const std::string fileName = std::string(TEST_FILES_DIR) + "eventOverrun.T";
+
+    /* Expected IR */
+    std::vector<std::string> regexpr;
+    regexpr.push_back(R"(%EventDescriptor \{ ptr @event_id, i64 10000, ptr @control_thunk, ptr @control_argtypes, ptr @control_handle, i32 0, i32 50, i32 0, i32 1, i32 0, i32 0, i32 0, i64 0, i32 0 \})");
+
+    test(fileName, regexpr);
+}
+
+TEST(eventTest, eventPriority) {
+    const std::string fileName = std::string(TEST_FILES_DIR) + "eventPriority.T";
+
+    /* Expected IR */
+    std::vector<std::string> regexpr;
+    regexpr.push_back(R"(%EventDescriptor \{ ptr @event_id, i64 10000, ptr @control_thunk, ptr @control_argtypes, ptr @control_handle, i32 0, i32 0, i32 0, i32 0, i32 7, i32 0, i32 0, i64 0, i32 0 \})");
+    regexpr.push_back(R"(%EventDescriptor \{ ptr @event_id.*, i64 100000, ptr @logger_thunk, ptr @logger_argtypes, ptr @logger_handle, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i64 0, i32 0 \})");
+
+    test(fileName, regexpr);
+}
+
+TEST(eventTest, eventBatch) {
+    const std::string fileName = std::string(TEST_FILES_DIR) + "eventBatch.T";
+
+    /* Expected IR */
+    std::vector<std::string> regexpr;
+    regexpr.push_back(R"(entry:[[:space:]]+([[:print:]]*alloca[[:print:]]*[[:space:]]+)*%event_argv = alloca ptr)");
+    regexpr.push_back(R"(call void @batchEventData\(i64 %event_handle, ptr %event_argv\))");
+    regexpr.push_back(R"(endLoop:[[:print:]]*[[:space:]]+call void @flushEventBatch\(\))");
+
+    test(fileName, regexpr);
+}
+
+TEST(eventTest, eventSlack) {
+    const std::string fileName = std::string(TEST_FILES_DIR) + "eventSlack.T";
+
+    /* Expected IR */
+    std::vector<std::string> regexpr;
+    regexpr.push_back(R"(ptr @sensor_handle, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i64 20000, i32 0 \})");
+    regexpr.push_back(R"(call void @configureEventSlack\(i64 %event_handle, i64 5000000\))");
+
+    test(fileName, regexpr);
+}
+
+TEST(eventTest, eventAligned) {
+    const std::string fileName = std::string(TEST_FILES_DIR) + "eventAligned.T";
+
+    /* Expected IR */
+    std::vector<std::string> regexpr;
+    regexpr.push_back(R"(ptr @sampler_handle, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i64 0, i32 0 \})");
+    regexpr.push_back(R"(ptr @clock_handle, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i64 0, i32 1 \})");
+
+    test(fileName, regexpr);
+}
+
+TEST(eventTest, eventQueue) {
+    const std::string fileName = std::string(TEST_FILES_DIR) + "eventQueue.T";
+
+    /* Expected IR */
+    std::vector<std::string> regexpr;
+    regexpr.push_back(R"(ptr @consumer_handle, i32 1, i32 0, i32 0, i32 0, i32 0, i32 16, i32 1, i64 0, i32 0 \})");
+
+    test(fileName, regexpr);
+}
+
+TEST(eventTest, eventModifierNames) {
+    const std::string fileName = std::string(TEST_FILES_DIR) + "eventModifierNames.T";
+
+    /* Expected IR, the modifier words name variables outside of the event definition */
+    std::vector<std::string> regexpr;
+    regexpr.push_back(R"(%queue_ptr = alloca i32)");
+    regexpr.push_back(R"(%block_ptr = alloca i32)");
+    regexpr.push_back(R"(%skip_ptr = alloca i32)");
+    regexpr.push_back(R"(%us_ptr = alloca i32)");
+    regexpr.push_back(R"(ptr @consumer_handle, i32 1, i32 0, i32 0, i32 0, i32 0, i32 16, i32 0, i64 0, i32 0 \})");
+
+    test(fileName, regexpr);
+}
+
+TEST(eventTest, eventTable) {
+    const std::string fileName = std::string(TEST_FILES_DIR) + "eventTable.T";
+
+    /* Expected IR */
+    std::vector<std::string> regexpr;
+    regexpr.push_back(R"(@event_table = private constant \[1 x %EventDescriptor\] \[%EventDescriptor \{ ptr @event_id\.1, i64 50000, ptr @used_thunk)");
+    regexpr.push_back(R"(entry:[[:space:]]+([[:print:]]*alloca[[:print:]]*[[:space:]]+)*call void @registerEventTable\(ptr @event_table, i32 1\))");
+    regexpr.push_back(R"(define void @unused\(\))");
+
+    test(fileName, regexpr);
+}
+
+TEST(eventTest, eventMicro) {
+    const std::string fileName = std::string(TEST_FILES_DIR) + "eventMicro.T";
+
+    /* Expected IR */
+    std::vector<std::string> regexpr;
+    regexpr.push_back(R"(%EventDescriptor \{ ptr @event_id, i64 20, ptr @sample_thunk)");
+
+    test(fileName, regexpr);
+}
+
+TEST(eventTest, eventPeriodVariable) {
+    const std::string fileName = std::string(TEST_FILES_DIR) + "eventEvery.T";
+
+    /* Expected IR */
+    std::vector<std::string> regexpr;
+    regexpr.push_back(R"(fpext float %.* to double)");
+    regexpr.push_back(R"(fmul double %ticks_wide, 1\.000000e\+03)");
+    regexpr.push_back(R"(call double @llvm\.round\.f64\(double %period_us\))");
+    regexpr.push_back(R"(fptosi double %.* to i64)");
+
+    test(fileName, regexpr);
+}
+
+TEST(eventTest, eventCoroutine) {
+    const std::string fileName = std::string(TEST_FILES_DIR) + "eventCoroutine.T";
+
+    /* Expected IR */
+    std::vector<std::string> regexpr;
+    regexpr.push_back(R"(define ptr @blink\(i32 %x\))");
+    regexpr.push_back(R"(%coro_frame = call ptr @llvm\.coro\.begin\(token %coro_id, ptr %coro_mem\))");
+    regexpr.push_back(R"(call void @suspendEvent\(ptr %coro_frame, i64 200000\))");
+    regexpr.push_back(R"(%suspend_state = call i8 @llvm\.coro\.suspend\(token none, i1 false\))");
+    regexpr.push_back(R"(call void @suspendEvent\(ptr %coro_frame, i64 0\))");
+    regexpr.push_back(R"(call void @free\(ptr %coro_free\))");
+
+    test(fileName, regexpr);
+}
+
 /**
  * @brief Runs the tests associated with expressions.
  */
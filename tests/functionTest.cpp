@@ -44,6 +44,32 @@ TEST(functionTest, functionCallRef) {
     test(fileName, regexpr);
 }
 
+TEST(functionTest, functionStringScope) {
+    const std::string fileName = std::string(TEST_FILES_DIR) + "functionStringScope.T";
+
+    /* Expected IR */
+    std::vector<std::string> regexpr;
+    regexpr.push_back(R"(%string_scope = call i64 @enterStringScope\(\))");
+    regexpr.push_back(R"(%ret_str = call %TString @leaveStringScopeKeeping\(i64 %string_scope, ptr %str_data, i64 %str_len\))");
+    regexpr.push_back(R"(ret %TString %ret_str)");
+    regexpr.push_back(R"(%print_scope = call i64 @enterStringScope\(\))");
+    regexpr.push_back(R"(call void \(i32, \.\.\.\) @print\(i32 2, [[:print:]]*\)[[:space:]]+call void @leaveStringScope\(i64 %print_scope\))");
+    regexpr.push_back(R"(call void @leaveStringScope\(i64 %string_scope\)[[:space:]]+ret void)");
+
+    test(fileName, regexpr);
+}
+
+TEST(functionTest, functionRefString) {
+    const std::string fileName = std::string(TEST_FILES_DIR) + "functionRefString.T";
+
+    /* Expected IR, the string stored through the reference is copied to the buffer of the variable */
+    std::vector<std::string> regexpr;
+    regexpr.push_back(R"(call void @storeRefString\(ptr %name, ptr %str_data, i64 %str_len\))");
+    regexpr.push_back(R"(call void @setName\(ptr %a_ptr, i32 1\))");
+
+    test(fileName, regexpr);
+}
+
 /**
  * @brief Runs the tests associated with functions.
  */
@@ -29,6 +29,21 @@ TEST(loopTest, forStatement) {
     test(fileName, regexpr);
 }
 
+TEST(loopTest, loopStrings) {
+    const std::string fileName = std::string(TEST_FILES_DIR) + "loopStrings.T";
+
+    /* Expected IR, both loops release their strings in each iteration, the second one keeping `last` */
+    std::vector<std::string> regexpr;
+    regexpr.push_back(R"(%loop_scope = call i64 @enterStringScope\(\)[[:space:]]+br label %condition[[:space:]])");
+    regexpr.push_back(R"(loop:[[:print:]]*[[:space:]]+([[:print:]]*alloca[[:print:]]*[[:space:]]+)*call void @leaveStringScope\(i64 %loop_scope\))");
+    regexpr.push_back(R"(endLoop:[[:print:]]*[[:space:]]+call void @leaveStringScope\(i64 %loop_scope\))");
+    regexpr.push_back(R"(%loop_scope[0-9]+ = call i64 @enterStringScope\(\)[[:space:]]+br label %condition[0-9]+)");
+    regexpr.push_back(R"(loop[0-9]+:[[:print:]]*[[:space:]]+call void \(i64, i32, \.\.\.\) @leaveStringScopeKeepingVars\(i64 %loop_scope[0-9]+, i32 1, ptr %last_ptr\))");
+    regexpr.push_back(R"(endLoop[0-9]+:[[:print:]]*[[:space:]]+call void \(i64, i32, \.\.\.\) @leaveStringScopeKeepingVars\(i64 %loop_scope[0-9]+, i32 1, ptr %last_ptr\))");
+
+    test(fileName, regexpr);
+}
+
 /**
  * @brief Runs the tests associated with loops.
  */
@@ -0,0 +1,450 @@
+#include "ArgQueue.h"
+#include "Scheduler.h"
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+/* Bodies of the test events */
+static std::atomic<int> activations{0};
+static std::atomic<int> tornReads{0};
+
+/* Two int parameters */
+static const int PAIR_TYPES[] = {1, 1};
+
+static void countActivation(void **) {
+    activations.fetch_add(1);
+}
+
+static void checkPair(void **argv) {
+    if (*static_cast<int *>(argv[0]) != -*static_cast<int *>(argv[1]))
+        tornReads.fetch_add(1);
+}
+
+/* Deadlines of the activations of two periodic events, in execution order */
+static Event *fastEvent = nullptr;
+static Event *slowEvent = nullptr;
+static std::vector<std::pair<int, Event::Clock::time_point>> timeline;
+
+static void recordFast(void **) {
+    timeline.emplace_back(0, fastEvent->getDeadline());
+}
+
+static void recordSlow(void **) {
+    timeline.emplace_back(1, slowEvent->getDeadline());
+}
+
+/* Queued consumer and the event body that produces its tuples */
+static const int INT_TYPES[] = {1};
+static std::atomic<int> consumed{0};
+static Scheduler *producerScheduler = nullptr;
+static Event *consumerEvent = nullptr;
+
+static void consumeInt(void **argv) {
+    consumed.fetch_add(*static_cast<int *>(argv[0]));
+}
+
+static void produceInts(void **) {
+    int value = 0;
+    void *args[1] = {&value};
+    for (value = 1; value <= 3; ++value) {
+        consumerEvent->setArgsCopy(args, producerScheduler->mayBlock());
+    }
+}
+
+/* One string parameter, checked against the last value sent */
+static const int STRING_TYPES[] = {3};
+static std::string expectedText;
+static std::atomic<int> wrongStrings{0};
+
+static void checkString(void **argv) {
+    const TString *value = static_cast<TString *>(argv[0]);
+    if (value->length != static_cast<std::int64_t>(expectedText.size()) || expectedText != value->data)
+        wrongStrings.fetch_add(1);
+}
+
+/* After event that cancels and schedules itself again during its first activation */
+static Scheduler *restartScheduler = nullptr;
+static Event *restartEvent = nullptr;
+
+static void restartOnce(void **) {
+    if (activations.fetch_add(1) > 0)
+        return;
+
+    restartScheduler->cancel(*restartEvent);
+    restartScheduler->activate(restartEvent);
+}
+
+static void checkRepeatedChar(void **argv) {
+    const TString *value = static_cast<TString *>(argv[0]);
+    for (std::int64_t i = 0; i < value->length; ++i) {
+        if (value->data[i] != value->data[0])
+            wrongStrings.fetch_add(1);
+    }
+    if (value->data[value->length] != '\0')
+        wrongStrings.fetch_add(1);
+}
+
+TEST(runtimeTest, argQueueWraparound) {
+    ArgQueue queue(3, 2);
+    std::uint64_t tuple[2];
+
+    /* Several laps over the 3 cells, the tuples keep their order */
+    for (std::uint64_t i = 0; i < 10; ++i) {
+        std::uint64_t in[2] = {i, i * 100};
+        EXPECT_TRUE(queue.tryPush(in));
+        ASSERT_TRUE(queue.tryPop(tuple));
+        EXPECT_EQ(tuple[0], i);
+        EXPECT_EQ(tuple[1], i * 100);
+    }
+
+    EXPECT_FALSE(queue.tryPop(tuple));
+}
+
+TEST(runtimeTest, argQueueFull) {
+    ArgQueue queue(3, 1);
+
+    for (std::uint64_t i = 0; i < 3; ++i) {
+        EXPECT_TRUE(queue.tryPush(&i));
+    }
+
+    /* Full until a tuple is taken */
+    std::uint64_t extra = 3;
+    EXPECT_FALSE(queue.tryPush(&extra));
+    EXPECT_TRUE(queue.tryPop(nullptr));
+    EXPECT_TRUE(queue.tryPush(&extra));
+
+    std::uint64_t value;
+    for (std::uint64_t expected = 1; expected <= 3; ++expected) {
+        ASSERT_TRUE(queue.tryPop(&value));
+        EXPECT_EQ(value, expected);
+    }
+    EXPECT_FALSE(queue.tryPop(&value));
+}
+
+TEST(runtimeTest, argQueueSingleCell) {
+    ArgQueue queue(1, 1);
+    std::uint64_t value = 1;
+
+    /* A written cell is not free for the next lap until it is taken */
+    EXPECT_TRUE(queue.tryPush(&value));
+    EXPECT_FALSE(queue.tryPush(&value));
+    ASSERT_TRUE(queue.tryPop(&value));
+    EXPECT_FALSE(queue.tryPop(&value));
+    EXPECT_TRUE(queue.tryPush(&value));
+}
+
+TEST(runtimeTest, overrunSkip) {
+    Event ev("skip", 10ms, countActivation, 0, nullptr, 0);
+    Event::Clock::time_point start = Event::Clock::now();
+    ev.resetDeadline(start, start);
+
+    /* The slots at 10, 20 and 30 ms are missed, the next one keeps the phase */
+    EXPECT_EQ(ev.nextDeadline(start + 35ms), start + 40ms);
+    EXPECT_EQ(ev.getMissedDeadlines(), 3u);
+}
+
+TEST(runtimeTest, overrunCatchUp) {
+    Event ev("catchUp", 10ms, countActivation, 0, nullptr, 0);
+    ev.setOverrun(Overrun::CATCH_UP);
+    Event::Clock::time_point start = Event::Clock::now();
+    ev.resetDeadline(start, start);
+
+    /* Every missed slot runs back to back */
+    EXPECT_EQ(ev.nextDeadline(start + 35ms), start + 10ms);
+    EXPECT_EQ(ev.nextDeadline(start + 35ms), start + 20ms);
+    EXPECT_EQ(ev.nextDeadline(start + 35ms), start + 30ms);
+    EXPECT_EQ(ev.nextDeadline(start + 35ms), start + 40ms);
+    EXPECT_EQ(ev.getMissedDeadlines(), 3u);
+}
+
+TEST(runtimeTest, overrunCoalesce) {
+    Event ev("coalesce", 10ms, countActivation, 0, nullptr, 0);
+    ev.setOverrun(Overrun::COALESCE);
+    Event::Clock::time_point start = Event::Clock::now();
+    ev.resetDeadline(start, start);
+
+    /* The missed slots run once immediately, then the phase is kept */
+    EXPECT_EQ(ev.nextDeadline(start + 35ms), start + 35ms);
+    EXPECT_EQ(ev.nextDeadline(start + 36ms), start + 40ms);
+    EXPECT_EQ(ev.getMissedDeadlines(), 3u);
+}
+
+TEST(runtimeTest, rearmedSingleActivation) {
+    Event at("at", 10ms, countActivation, 0, nullptr, 0, EventKind::AT);
+    Event after("after", 10ms, countActivation, 0, nullptr, 0, EventKind::AFTER);
+    Event::Clock::time_point start = Event::Clock::now();
+    at.resetDeadline(start, start);
+    after.resetDeadline(start, start);
+
+    /* The `at` time has passed so it runs now, the `after` delay counts again from now */
+    EXPECT_EQ(at.nextDeadline(start + 15ms), start + 15ms);
+    EXPECT_EQ(after.nextDeadline(start + 15ms), start + 25ms);
+    EXPECT_EQ(at.getMissedDeadlines(), 0u);
+}
+
+TEST(runtimeTest, staggeredPhases) {
+    std::vector<std::unique_ptr<Event>> events;
+    for (int i = 0; i < 5; ++i) {
+        events.push_back(std::make_unique<Event>("phase", 100ms, countActivation, 0, nullptr, 0));
+    }
+    events[4]->setAligned();
+
+    /* With the virtual clock the events are armed at the start of the program */
+    Scheduler scheduler(1);
+    scheduler.useVirtualTime(0ms);
+    scheduler.enableStagger();
+    for (auto &ev : events) {
+        scheduler.activate(ev.get());
+    }
+
+    Event::Clock::time_point origin = events[0]->getDeadline();
+    EXPECT_EQ(events[1]->getDeadline() - origin, 50ms);
+    EXPECT_EQ(events[2]->getDeadline() - origin, 25ms);
+    EXPECT_EQ(events[3]->getDeadline() - origin, 75ms);
+    EXPECT_EQ(events[4]->getDeadline() - origin, 0ms);
+}
+
+TEST(runtimeTest, seqlockPublication) {
+    Event ev("pair", 0ms, checkPair, 2, PAIR_TYPES, 0);
+    tornReads = 0;
+
+    int first = 0;
+    int second = 0;
+    void *argv[2] = {&first, &second};
+    ev.setArgsCopy(argv);
+
+    /* Every activation reads a pair published as a whole */
+    std::atomic<bool> done{false};
+    std::thread writer([&]() {
+        int a = 0;
+        int b = 0;
+        void *args[2] = {&a, &b};
+        for (int i = 1; i <= 200000; ++i) {
+            a = i;
+            b = -i;
+            ev.setArgsCopy(args);
+        }
+        done = true;
+    });
+
+    while (!done) {
+        ev.execute();
+    }
+    writer.join();
+
+    EXPECT_EQ(tornReads.load(), 0);
+}
+
+TEST(runtimeTest, slackCoalescing) {
+    std::vector<std::unique_ptr<Event>> events;
+    for (int i = 0; i < 8; ++i) {
+        events.push_back(std::make_unique<Event>("slack", std::chrono::milliseconds(10 + i), countActivation, 0,
+                                                 nullptr, 0, EventKind::AFTER));
+        events.back()->setSlack(20ms);
+    }
+
+    /* Due between 10 and 17 ms, all of them fit in the slack of the first one */
+    activations = 0;
+    Scheduler scheduler(1);
+    for (auto &ev : events) {
+        scheduler.activate(ev.get());
+    }
+    scheduler.waitIdle();
+
+    TimerStats stats = scheduler.getTimerStats();
+    EXPECT_EQ(activations.load(), 8);
+    EXPECT_EQ(stats.activations, 8u);
+    EXPECT_EQ(stats.wakeups, 1u);
+    EXPECT_GT(stats.coalesced, 0u);
+}
+
+TEST(runtimeTest, cancelledTimerEntry) {
+    Event ev("restart", 10ms, countActivation, 0, nullptr, 0);
+
+    /* The entry of the cancelled activation is dropped, a single chain runs from 0 to 50 ms */
+    activations = 0;
+    Scheduler scheduler(1);
+    scheduler.useVirtualTime(50ms);
+    scheduler.activate(&ev);
+    scheduler.cancel(ev);
+    scheduler.activate(&ev);
+    scheduler.waitIdle();
+
+    EXPECT_EQ(activations.load(), 6);
+}
+
+TEST(runtimeTest, rescheduleWhileStopping) {
+    Event ev("restart", 10ms, restartOnce, 0, nullptr, 0, EventKind::AFTER);
+
+    /* The schedule requested after the cancel is kept, the event runs a second time */
+    activations = 0;
+    Scheduler scheduler(1);
+    scheduler.useVirtualTime(100ms);
+    restartScheduler = &scheduler;
+    restartEvent = &ev;
+    scheduler.activate(&ev);
+    scheduler.waitIdle();
+
+    EXPECT_EQ(activations.load(), 2);
+}
+
+TEST(runtimeTest, blockingQueueFromWorker) {
+    Event consumer("consumer", 1ms, consumeInt, 1, INT_TYPES, 1);
+    consumer.enableQueue(1, QueueFull::BLOCK);
+    Event producer("producer", 0ms, produceInts, 0, nullptr, 0, EventKind::AFTER);
+
+    /* The only worker runs the producer, waiting would starve the consumer so the tuples that do not fit are dropped */
+    consumed = 0;
+    Scheduler scheduler(1);
+    producerScheduler = &scheduler;
+    consumerEvent = &consumer;
+    scheduler.activate(&consumer);
+    scheduler.activate(&producer);
+    scheduler.waitIdle();
+
+    EXPECT_EQ(consumer.getDroppedArgs(), 2u);
+    EXPECT_EQ(consumed.load(), 1);
+}
+
+TEST(runtimeTest, blockingQueueWakeUp) {
+    Event consumer("consumer", 1ms, consumeInt, 1, INT_TYPES, 3);
+    consumer.enableQueue(1, QueueFull::BLOCK);
+
+    /* The caller waits for each activation to take the previous tuple */
+    consumed = 0;
+    Scheduler scheduler(1);
+    scheduler.activate(&consumer);
+    int value = 0;
+    void *args[1] = {&value};
+    for (value = 1; value <= 3; ++value) {
+        consumer.setArgsCopy(args, scheduler.mayBlock());
+    }
+    scheduler.waitIdle();
+
+    EXPECT_EQ(consumer.getDroppedArgs(), 0u);
+    EXPECT_EQ(consumed.load(), 6);
+}
+
+TEST(runtimeTest, virtualHorizon) {
+    Event fast("fast", 10ms, recordFast, 0, nullptr, 0);
+    Event slow("slow", 15ms, recordSlow, 0, nullptr, 0);
+    fastEvent = &fast;
+    slowEvent = &slow;
+    timeline.clear();
+
+    setenv("T_VIRTUAL", "1", 1);
+    setenv("T_VIRTUAL_HORIZON", "0.095", 1);
+    Scheduler::Clock::duration horizon;
+    bool enabled = Scheduler::virtualTimeFromEnv(horizon);
+    unsetenv("T_VIRTUAL");
+    unsetenv("T_VIRTUAL_HORIZON");
+    ASSERT_TRUE(enabled);
+
+    /* The periodic events never stop, the run ends at the horizon with every activation in deadline order */
+    Scheduler scheduler(1);
+    scheduler.useVirtualTime(horizon);
+    scheduler.activate(&fast);
+    scheduler.activate(&slow);
+    scheduler.waitIdle();
+
+    int counts[2] = {0, 0};
+    for (std::size_t i = 0; i < timeline.size(); ++i) {
+        ++counts[timeline[i].first];
+        if (i > 0) {
+            EXPECT_LE(timeline[i - 1].second, timeline[i].second);
+        }
+    }
+    EXPECT_EQ(counts[0], 10); // 0 to 90 ms
+    EXPECT_EQ(counts[1], 7);  // 0 to 90 ms
+    EXPECT_EQ(timeline.back().second - timeline.front().second, 90ms);
+}
+
+TEST(runtimeTest, virtualBlockingQueue) {
+    Event consumer("consumer", 1ms, consumeInt, 1, INT_TYPES, 0);
+    consumer.enableQueue(1, QueueFull::BLOCK);
+
+    /* The activations only run after the producer returns, so the tuples that do not fit are dropped */
+    consumed = 0;
+    Scheduler scheduler(1);
+    scheduler.useVirtualTime(10ms);
+    scheduler.activate(&consumer);
+    int value = 0;
+    void *args[1] = {&value};
+    for (value = 1; value <= 3; ++value) {
+        consumer.setArgsCopy(args, scheduler.mayBlock());
+    }
+    scheduler.waitIdle();
+
+    EXPECT_EQ(consumer.getDroppedArgs(), 2u);
+    EXPECT_EQ(consumed.load(), 1);
+}
+
+TEST(runtimeTest, longStringArgs) {
+    Event published("published", 0ms, checkString, 1, STRING_TYPES, 0);
+    Event queued("queued", 0ms, checkString, 1, STRING_TYPES, 0);
+    queued.enableQueue(2, QueueFull::DROP_OLDEST);
+    wrongStrings = 0;
+
+    /* The events own a copy of each long string, the source buffer is reused for the next value */
+    std::string text;
+    TString value{};
+    void *args[1] = {&value};
+    for (int i = 0; i < 100; ++i) {
+        text = "a string longer than the slot " + std::to_string(i);
+        value = {text.c_str(), static_cast<std::int64_t>(text.size())};
+        published.setArgsCopy(args);
+        queued.setArgsCopy(args);
+        text.assign(text.size(), '-');
+
+        expectedText = "a string longer than the slot " + std::to_string(i);
+        published.execute();
+        queued.execute();
+    }
+
+    /* The queued copies that are never taken are freed with the event */
+    queued.setArgsCopy(args);
+    queued.setArgsCopy(args);
+    queued.setArgsCopy(args);
+
+    EXPECT_EQ(wrongStrings.load(), 0);
+    EXPECT_EQ(queued.getDroppedArgs(), 1u);
+}
+
+TEST(runtimeTest, longStringPublication) {
+    Event ev("strings", 0ms, checkRepeatedChar, 1, STRING_TYPES, 0);
+    wrongStrings = 0;
+
+    std::string first(20, 'a');
+    TString value{first.c_str(), static_cast<std::int64_t>(first.size())};
+    void *argv[1] = {&value};
+    ev.setArgsCopy(argv);
+
+    /* The strings replaced while a activation copies them stay valid until it finishes */
+    std::atomic<bool> done{false};
+    std::thread writer([&]() {
+        std::string text;
+        TString next{};
+        void *args[1] = {&next};
+        for (int i = 0; i < 100000; ++i) {
+            text.assign(16 + i % 40, static_cast<char>('a' + i % 26));
+            next = {text.c_str(), static_cast<std::int64_t>(text.size())};
+            ev.setArgsCopy(args);
+        }
+        done = true;
+    });
+
+    while (!done) {
+        ev.execute();
+    }
+    writer.join();
+
+    EXPECT_EQ(wrongStrings.load(), 0);
+}
@@ -126,8 +126,19 @@ TEST(variableTest, variableShadowing) {
 
     /* Expected IR */
     std::vector<std::string> regexpr;
-    regexpr.push_back(R"(ptr %a_val, ptr null)");
-    regexpr.push_back(R"(ptr %a_val1, ptr null)"); // This a_val1 shadows a_val
+    regexpr.push_back(R"(extractvalue %TString %a_val, 0)");
+    regexpr.push_back(R"(extractvalue %TString %a_val1, 0)"); // This a_val1 shadows a_val
+
+    test(fileName, regexpr);
+}
+
+TEST(variableTest, variableStringLength) {
+    const std::string fileName = std::string(TEST_FILES_DIR) + "varStringLength.T";
+
+    /* Expected IR */
+    std::vector<std::string> regexpr;
+    regexpr.push_back(R"(store %TString \{ ptr @str, i64 5 \}, ptr %a_ptr)");
+    regexpr.push_back(R"(%str_len32 = trunc i64 %str_len to i32)");
 
     test(fileName, regexpr);
 }